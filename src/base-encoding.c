@@ -2,6 +2,8 @@
  * MIT License, see root folder for full license.
  */
 #include "base-encoding.h"
+#include "hex.h"
+#include <stdint.h>
 
 /** array of base10 alphabet letters */
 static const char BASE_2_ALPHABET[] = { '0', '1' };
@@ -9,9 +11,6 @@ static const char BASE_2_ALPHABET[] = { '0', '1' };
 /** array of base10 alphabet letters */
 static const char BASE_10_ALPHABET[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9' };
 
-/** array of base16 alphabet letters */
-static const char BASE_16_ALPHABET[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
-
 /** array of base10 alphabet letters */
 static const char BASE_32_ALPHABET[] = {
 	'1', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H',
@@ -25,242 +24,468 @@ static const char BASE_58_ALPHABET[] = {
 	'w', 'x', 'y', 'z'
 };
 
-/** encodes in_length bytes from in into the given base, using the given alphabet. writes the converted bytes to out, stopping when it converts out_length bytes. */
-static unsigned int encode_base_x(const char * alphabet, const unsigned int alphabet_len,
-                                  const void * in, const unsigned int in_length,
-                                  char * out,  const unsigned int out_length,
-                                  const bool enable_debug);
+/** powers of 58, 58^BASE_58_CHUNK_DIGITS is the largest chunk divisor divide_limbs takes. */
+static const uint32_t BASE_58_POWERS[] = { 1, 58, 3364, 195112, 11316496, 656356768 };
+
+/** encodes in_length bytes from in into a power of two base. writes the converted bytes to out, stopping when it converts out_length bytes. */
+static unsigned int encode_base_pow2(const char * alphabet, const unsigned int bits_per_digit,
+                                     const unsigned char * in, const unsigned int in_len,
+                                     char * out, const unsigned int out_len,
+                                     const bool suffix_only);
+
+/** encodes in_length bytes from in into lower case base-16, a byte at a time. writes the converted bytes to out, stopping when it converts out_length bytes. */
+static unsigned int encode_base_hex(const unsigned char * in, const unsigned int in_len,
+                                    char * out, const unsigned int out_len,
+                                    const bool suffix_only);
+
+/** encodes in_length bytes from in into the given base, several digits per division pass. writes the converted bytes to out, stopping when it converts out_length bytes. */
+static unsigned int encode_base_chunked(const char * alphabet, const unsigned int alphabet_len,
+                                        const uint32_t chunk_divisor, const unsigned int chunk_digits,
+                                        const unsigned char * in, const unsigned int in_length,
+                                        char * out, const unsigned int out_length,
+                                        uint32_t * scratch, const unsigned int scratch_limbs,
+                                        const bool suffix_only);
+
+/** loads big-endian bytes into 32-bit limbs, most significant limb first. */
+static unsigned int load_limbs(const unsigned char * in, const unsigned int in_len,
+                               uint32_t * limbs);
+
+/** divides the limbs in place by a chunk divisor, and returns the remainder. */
+static uint32_t divide_limbs(uint32_t * limbs, const unsigned int limbs_len,
+                                  const uint32_t divisor);
+
+/**
+ * encodes in_length bytes from in into the given base, dividing in place in the caller's scratch limbs,
+ * and writing the digits straight into out. see base-encoding.h.
+ */
+unsigned int encode_base_in_place(const unsigned int base,
+                                  const void *in, const unsigned int in_length,
+                                  char *out, const unsigned int out_length,
+                                  uint32_t *scratch, const unsigned int scratch_limbs,
+                                  const bool suffix_only) {
+	switch(base) {
+	case 2:
+		return encode_base_pow2(BASE_2_ALPHABET, 1, in, in_length, out, out_length, suffix_only);
+	case 10:
+		return encode_base_chunked(BASE_10_ALPHABET, sizeof(BASE_10_ALPHABET), BASE_10_CHUNK_DIVISOR, BASE_10_CHUNK_DIGITS,
+		                           in, in_length, out, out_length, scratch, scratch_limbs, suffix_only);
+	case 16:
+		return encode_base_hex(in, in_length, out, out_length, suffix_only);
+	case 32:
+		return encode_base_pow2(BASE_32_ALPHABET, 5, in, in_length, out, out_length, suffix_only);
+	case 58:
+		return encode_base_chunked(BASE_58_ALPHABET, sizeof(BASE_58_ALPHABET), BASE_58_POWERS[BASE_58_CHUNK_DIGITS], BASE_58_CHUNK_DIGITS,
+		                           in, in_length, out, out_length, scratch, scratch_limbs, suffix_only);
+	default:
+		THROW(0x6D13);
+	}
+	return 0;
+}
+
+/** looks up the alphabet and chunk size of base 10 or 58, throws an error for any other base. */
+static void select_chunked_base(const unsigned int base,
+                                const char ** alphabet, unsigned int * alphabet_len,
+                                uint32_t * chunk_divisor, unsigned int * chunk_digits) {
+	switch(base) {
+	case 10:
+		*alphabet = BASE_10_ALPHABET;
+		*alphabet_len = sizeof(BASE_10_ALPHABET);
+		*chunk_divisor = BASE_10_CHUNK_DIVISOR;
+		*chunk_digits = BASE_10_CHUNK_DIGITS;
+		break;
+	case 58:
+		*alphabet = BASE_58_ALPHABET;
+		*alphabet_len = sizeof(BASE_58_ALPHABET);
+		*chunk_divisor = BASE_58_POWERS[BASE_58_CHUNK_DIGITS];
+		*chunk_digits = BASE_58_CHUNK_DIGITS;
+		break;
+	default:
+		THROW(0x6D13);
+	}
+}
+
+/**
+ * converts in_length bytes from in into chunks of digits, see base-encoding.h.
+ * the input is divided in the bottom of scratch as in encode_chunks_software, and each remainder is stored
+ * downwards from the top of scratch, so the most significant chunk ends up lowest.
+ */
+unsigned int encode_base_chunks(const unsigned int base,
+                                const void *in_raw, const unsigned int in_length,
+                                uint32_t *scratch, const unsigned int scratch_limbs) {
+	const char * alphabet = NULL;
+	unsigned int alphabet_len = 0;
+	uint32_t chunk_divisor = 0;
+	unsigned int chunk_digits = 0;
+	select_chunked_base(base, &alphabet, &alphabet_len, &chunk_divisor, &chunk_digits);
+
+	const unsigned char * in = in_raw;
+	unsigned int in_len = in_length;
+	while((in_len > 0) && (*in == 0)) {
+		in++;
+		in_len--;
+	}
+
+	// if the input does not fit in the scratch, throw an error.
+	if(BASEX_SCRATCH_LIMBS(in_len) >= scratch_limbs) {
+		THROW(0x6D12);
+	}
+
+	// the first limb is nonzero, as the leading zero bytes are gone.
+	const unsigned int limbs_len = load_limbs(in, in_len, scratch);
+	unsigned int limbs_start = 0;
+
+	unsigned int chunks_len = 0;
+	do {
+		uint32_t chunk = 0;
+		if(limbs_start < limbs_len) {
+			chunk = divide_limbs(scratch + limbs_start, limbs_len - limbs_start, chunk_divisor);
+			if(scratch[limbs_start] == 0) {
+				limbs_start++;
+			}
+		}
+		if((limbs_len + chunks_len) >= scratch_limbs) {
+			THROW(0x6D12);
+		}
+		chunks_len++;
+		scratch[scratch_limbs - chunks_len] = chunk;
+	} while(limbs_start < limbs_len);
+
+	// only the most significant chunk can be short.
+	unsigned int top_digits = 1;
+	uint32_t top_chunk = scratch[scratch_limbs - chunks_len] / alphabet_len;
+	while(top_chunk != 0) {
+		top_digits++;
+		top_chunk /= alphabet_len;
+	}
+	return ((chunks_len - 1) * chunk_digits) + top_digits;
+}
+
+/** passes the letters converted by encode_base_chunks to sink, see base-encoding.h. */
+void encode_base_stream(const unsigned int base,
+                        const uint32_t *scratch, const unsigned int scratch_limbs,
+                        const unsigned int letters_len,
+                        text_sink_t sink, void *context) {
+	const char * alphabet = NULL;
+	unsigned int alphabet_len = 0;
+	uint32_t chunk_divisor = 0;
+	unsigned int chunk_digits = 0;
+	select_chunked_base(base, &alphabet, &alphabet_len, &chunk_divisor, &chunk_digits);
+
+	// base 10 has the longest chunks.
+	char letters[BASE_10_CHUNK_DIGITS];
+	const unsigned int chunks_len = (letters_len + chunk_digits - 1) / chunk_digits;
+	unsigned int digits = letters_len - ((chunks_len - 1) * chunk_digits);
+	for(unsigned int chunk_ix = scratch_limbs - chunks_len; chunk_ix < scratch_limbs; chunk_ix++) {
+		uint32_t chunk = scratch[chunk_ix];
+		for(unsigned int c = digits; c > 0; c--) {
+			letters[c - 1] = *(alphabet + (chunk % alphabet_len));
+			chunk /= alphabet_len;
+		}
+		sink(context, letters, digits);
+		digits = chunk_digits;
+	}
+}
 
 /** encodes in_length bytes from in into base-2, writes the converted bytes to out, stopping when it converts out_length bytes.  */
 unsigned int encode_base_2(const void *in, const unsigned int in_length,
                            char *out, const unsigned int out_length,
                            const bool enable_debug) {
-	return encode_base_x(BASE_2_ALPHABET, sizeof(BASE_10_ALPHABET), in, in_length, out, out_length,
-	                     enable_debug);
+	UNUSED(enable_debug);
+	return encode_base_in_place(2, in, in_length, out, out_length, NULL, 0, false);
 }
 
 /** encodes in_length bytes from in into base-10, writes the converted bytes to out, stopping when it converts out_length bytes.  */
 unsigned int encode_base_10(const void *in, const unsigned int in_length,
                             char *out, const unsigned int out_length,
                             const bool enable_debug) {
-	return encode_base_x(BASE_10_ALPHABET, sizeof(BASE_10_ALPHABET), in, in_length, out, out_length,
-	                     enable_debug);
+	UNUSED(enable_debug);
+	uint32_t scratch[BASEX_LIMB_COUNT];
+	return encode_base_in_place(10, in, in_length, out, out_length, scratch, BASEX_LIMB_COUNT, false);
 }
 
-/** encodes in_length bytes from in into base-10, writes the converted bytes to out, stopping when it converts out_length bytes.  */
+/** encodes in_length bytes from in into base-16, writes the converted bytes to out, stopping when it converts out_length bytes.  */
 unsigned int encode_base_16(const void *in, const unsigned int in_length,
                             char *out, const unsigned int out_length,
                             const bool enable_debug) {
-	return encode_base_x(BASE_16_ALPHABET, sizeof(BASE_16_ALPHABET), in, in_length, out, out_length,
-	                     enable_debug);
+	UNUSED(enable_debug);
+	return encode_base_in_place(16, in, in_length, out, out_length, NULL, 0, false);
 }
 
 /** encodes in_length bytes from in into base-32, writes the converted bytes to out, stopping when it converts out_length bytes.  */
 unsigned int encode_base_32(const void *in, const unsigned int in_length,
                             char *out, const unsigned int out_length,
                             const bool enable_debug) {
-	return encode_base_x(BASE_32_ALPHABET, sizeof(BASE_32_ALPHABET), in, in_length, out, out_length, enable_debug);
+	UNUSED(enable_debug);
+	return encode_base_in_place(32, in, in_length, out, out_length, NULL, 0, false);
 }
 
-/** encodes in_length bytes from in into base-32, writes the converted bytes to out, stopping when it converts out_length bytes.  */
+/** encodes in_length bytes from in into base-58, writes the converted bytes to out, stopping when it converts out_length bytes.  */
 unsigned int encode_base_58(const void *in, const unsigned int in_length,
                             char *out, const unsigned int out_length,
                             const bool enable_debug) {
-	return encode_base_x(BASE_58_ALPHABET, sizeof(BASE_58_ALPHABET), in, in_length, out, out_length, enable_debug);
+	UNUSED(enable_debug);
+	uint32_t scratch[BASEX_LIMB_COUNT];
+	return encode_base_in_place(58, in, in_length, out, out_length, scratch, BASEX_LIMB_COUNT, false);
+}
+
+/** encodes in_length bytes from in into base-58, writes only the least significant out_length letters to out.  */
+unsigned int encode_base_58_suffix(const void *in, const unsigned int in_length,
+                                   char *out, const unsigned int out_length) {
+	uint32_t scratch[BASEX_LIMB_COUNT];
+	return encode_base_in_place(58, in, in_length, out, out_length, scratch, BASEX_LIMB_COUNT, true);
 }
 
 /**
- * this algorithm simulates a single step in long division.
- * for example:
- *  dividing 10 by 10 should get 1 remainder 0.
- *  dividing 11 by 10 should get 1 remainder 1.
- *  dividing 0D (13) by 10 should get 1 remainder 3
- * 6b6b00000001b60db6 => send 0d (13) to divide_and_remainder.
- *   9a00000000a9
- *   aa00000000aa
- *   ba00000001ab
- * cbcb00000010bc00000000000000000000000000000001bc => divide_and_remainder has remainder of 0x01.
- *   da0000000dad
- *   ea00000003ae => after subtraction 3.
+ * loads in_len big-endian bytes from in into 32-bit limbs, most significant limb first.
+ * the first limb holds whatever bytes are left over when in_len is not a multiple of four.
+ * returns the number of limbs written.
  */
-static unsigned int divide_and_remainder(const unsigned char * divided, const unsigned int divided_len,
-                                         unsigned char * dividend, const unsigned int dividend_len,
-                                         const unsigned int divisor, const unsigned int radix,
-                                         const bool enable_debug) {
-  UNUSED(enable_debug);
-
-	unsigned int divided_part = 0;
-	unsigned int division_index = 0;
-	const unsigned int max_divisions = divided_len * radix;
-	// const unsigned int max_divisions = 1;
-	unsigned int cur_divisions = 0;
-	while(division_index < divided_len) {
-		cur_divisions++;
-		if(cur_divisions > max_divisions) {
-			THROW(0x6D16);
+static unsigned int load_limbs(const unsigned char * in, const unsigned int in_len,
+                               uint32_t * limbs) {
+	const unsigned int limbs_len = (in_len + BASEX_LIMB_SIZE - 1) / BASEX_LIMB_SIZE;
+	unsigned int in_ix = 0;
+	for(unsigned int limb_ix = 0; limb_ix < limbs_len; limb_ix++) {
+		unsigned int limb_bytes = BASEX_LIMB_SIZE;
+		if(limb_ix == 0) {
+			limb_bytes = in_len - ((limbs_len - 1) * BASEX_LIMB_SIZE);
 		}
-
-		// if the divided part is less than the divisor, add another digit.
-		// I.E: if you are dividing 31 by 4, and the divided part is 3, multiply 3 by 10 and add the 1.
-		if(divided_part < divisor) {
-			divided_part *= radix;
-			divided_part += *(divided + division_index);
-			division_index++;
-			// shift the dividend left, and set lowest byte to zero.
-			for(unsigned int ix = 1; ix < dividend_len; ix++) {
-				*(dividend + (ix-1)) = *(dividend + (ix));
-			}
-			*(dividend + (dividend_len-1)) = 0;
-		}
-		// if the divided part is now greater than the divisor, divide and take the remainder.
-		// this is done in a seperate conditional statement than the previous,
-		// because you are modifying the divided_part in the previous conditional.
-		// so the two if statements look like they can be combined but they cannot be combined.
-		if(divided_part >= divisor) {
-			if(division_index > divided_len) {
-				THROW(0x6D23);
-			}
-			unsigned int dividend_part = divided_part / divisor;
-			*(dividend + (dividend_len-1)) = dividend_part;
-			if(dividend_part > divided_part) {
-				THROW(0x6D22);
-			}
-			divided_part -= (dividend_part * divisor);
+		uint32_t limb = 0;
+		for(unsigned int c = 0; c < limb_bytes; c++) {
+			limb = (limb << 8) | *(in + in_ix);
+			in_ix++;
 		}
+		*(limbs + limb_ix) = limb;
 	}
-	return divided_part;
+	return limbs_len;
 }
 
-static bool dividedIsEmpty(const unsigned char * divided, const unsigned int divided_len) {
-	bool divided_all_zero = true;
-	for(unsigned int c = 0; c < divided_len; c++) {
-		if(*(divided+c) != 0) {
-			divided_all_zero = false;
-		}
+/**
+ * encodes in_len bytes from in into lower case base-16, with the same layout as encode_base_pow2,
+ * but two letters per input byte, looked up in the shared hex pair table.
+ */
+static unsigned int encode_base_hex(const unsigned char * in, const unsigned int in_len,
+                                    char * out, const unsigned int out_len,
+                                    const bool suffix_only) {
+	int in_ix = in_len - 1;
+	int out_ix = out_len - 1;
+	while((out_ix >= 1) && (in_ix >= 0)) {
+		const char * pair = HEX_PAIRS_LOWER + (*(in + in_ix) * 2);
+		*(out + out_ix - 1) = *(pair + 0);
+		*(out + out_ix) = *(pair + 1);
+		out_ix -= 2;
+		in_ix--;
 	}
-	bool empty_divided = false;
-	if(divided_all_zero) {
-		empty_divided = true;
+
+	// an odd out_len only has room for the low letter of the next byte.
+	bool high_nibble_left = false;
+	if((out_ix == 0) && (in_ix >= 0)) {
+		const unsigned char c = *(in + in_ix);
+		*out = HEX_PAIRS_LOWER[(c * 2) + 1];
+		high_nibble_left = (c >> 4) != 0;
+		out_ix--;
+		in_ix--;
 	}
-	return empty_divided;
-}
 
-/**
- * set in_len to be the initial length (in_len_raw) but strip off all leading zeros.
- * for each leading zero, subtract 1 from in_len, and shift the value in divided left one.
- */
-unsigned int remove_zeros(unsigned char * divided, const unsigned int divided_len_raw) {
-	// removes zeros from left side.
-	unsigned int divided_len = divided_len_raw;
-	while((divided_len > 0) && ((*divided) == 0x00)) {
-		for(unsigned int c = 1; c < divided_len; c++) {
-			*(divided + (c-1)) = *(divided + c);
-		}
-		divided_len--;
+	// pad the rest of the output with zeros.
+	while(out_ix >= 0) {
+		*(out + out_ix) = '0';
+		out_ix--;
+	}
+
+	if(suffix_only) {
+		return out_len;
 	}
 
-	// removes zeros from right side.
-	// while((divided_len > 0) && ((*divided + (divided_len-1)) == 0x00)) {
-	//  for(unsigned int c = 1; c < divided_len; c++) {
-	//    *(divided + (c-1)) = *(divided + c);
-	//  }
-	//  divided_len--;
-	// }
-	return divided_len;
+	// the output is full, so whatever is left of the input has to be zero.
+	if(high_nibble_left) {
+		THROW(0x6D24);
+	}
+	while(in_ix >= 0) {
+		if(*(in + in_ix) != 0) {
+			THROW(0x6D24);
+		}
+		in_ix--;
+	}
+	return out_len;
 }
 
-/** encodes in_length bytes from in into the given base, using the given alphabet. writes the converted bytes to out, stopping when it converts out_length bytes.
- * algorithm:
- * 1) start with a input in base256 (in), and a divisor (alphabet_len).
- * 2) Do long division, dividing the input by the divisor, saving the dividend_length, dividend and remainder.
- * 3) look up the remainder in the alphabet, save it in the output.
- * 4) if dividend_length = 0 return.
- * 4) use the dividend as a new input
- * 5) run steps 2,3,4 until the input
+/**
+ * encodes in_len bytes from in into a power of two base, by slicing bits_per_digit bits at a time
+ * off the least significant end of the input. this is linear in the input length, and needs no scratch.
+ * the output is out_len letters, left padded with the zero letter.
+ * if any nonzero bits are left over once the output is full, throw an error, unless suffix_only is set.
  */
-static unsigned int encode_base_x(const char * alphabet, const unsigned int alphabet_len,
-                                  const void * in, const unsigned int in_len_raw,
-                                  char * out, const unsigned int out_len,
-                                  const bool enable_debug) {
-
-	// divided (the thing to be divided)
-	// set to all zeros
-	unsigned char divided[BASEX_DIVISION_BUFFER_SIZE];
-	memset(divided,0x00,sizeof(divided));
-
-	// dividend (the primary result of division)
-	// set to all zeros
-	unsigned char dividend[BASEX_DIVISION_BUFFER_SIZE];
-	memset(dividend,0x00,sizeof(dividend));
-
-	// remainders (the secondary result of division, whatever remained after whole number division)
-	// set to all zeros
-	unsigned char remainders[BASEX_DIVISION_BUFFER_SIZE];
-	memset(remainders,0x00,sizeof(remainders));
-
-	// if out_len is too big, log the actual length, and throw an error.
-	if(out_len > BASEX_DIVISION_BUFFER_SIZE) {
-		THROW(0x6D11);
+static unsigned int encode_base_pow2(const char * alphabet, const unsigned int bits_per_digit,
+                                     const unsigned char * in, const unsigned int in_len,
+                                     char * out, const unsigned int out_len,
+                                     const bool suffix_only) {
+	const uint32_t digit_mask = (1u << bits_per_digit) - 1;
+
+	// bits read from the input but not yet written out as digits.
+	uint32_t bit_buffer = 0;
+	unsigned int bit_buffer_len = 0;
+
+	int in_ix = in_len - 1;
+	int out_ix = out_len - 1;
+	while(out_ix >= 0) {
+		// top up the bit buffer with the next byte, once it runs short of a full digit.
+		if((bit_buffer_len < bits_per_digit) && (in_ix >= 0)) {
+			bit_buffer |= ((uint32_t) *(in + in_ix)) << bit_buffer_len;
+			bit_buffer_len += 8;
+			in_ix--;
+		}
+		*(out + out_ix) = *(alphabet + (bit_buffer & digit_mask));
+		out_ix--;
+		if(bit_buffer_len > bits_per_digit) {
+			bit_buffer_len -= bits_per_digit;
+		} else {
+			bit_buffer_len = 0;
+		}
+		bit_buffer >>= bits_per_digit;
 	}
 
-	// remainders_offset, how many remainders there should be, equal to the output size.
-	const unsigned int remainders_offset = sizeof(remainders)-out_len;
-	// remainders_out, the pointer to the first remainder that will be saved (all before this will be zero).
-	unsigned char * remainders_out = remainders + remainders_offset;
-	// the current index into the remainders output.
-	int remainders_out_ix = out_len-1;
+	if(suffix_only) {
+		return out_len;
+	}
 
-	// if the input length is too big, log it and throw an error.
-	if(in_len_raw > BASEX_DIVISION_BUFFER_SIZE) {
-		THROW(0x6D12);
+	// the output is full, so whatever is left of the input has to be zero.
+	if(bit_buffer != 0) {
+		THROW(0x6D24);
+	}
+	while(in_ix >= 0) {
+		if(*(in + in_ix) != 0) {
+			THROW(0x6D24);
+		}
+		in_ix--;
 	}
+	return out_len;
+}
 
-	// make the first "divided" be the input.
-	memmove(divided, in, in_len_raw);
+#if defined(BASEX_HALF_LIMB_DIVIDE)
+/**
+ * divides the limbs in place by a divisor of up to 16 bits, and returns the remainder.
+ * each limb is divided as two 16-bit halves, so the remainder shifted up by a half always fits in 32 bits.
+ */
+static uint32_t divide_limbs(uint32_t * limbs, const unsigned int limbs_len,
+                             const uint32_t divisor) {
+	uint32_t remainder = 0;
+	for(unsigned int limb_ix = 0; limb_ix < limbs_len; limb_ix++) {
+		const uint32_t limb = *(limbs + limb_ix);
 
-	unsigned int working_len = remove_zeros(divided, in_len_raw);
+		uint32_t divided_part = (remainder << 16) | (limb >> 16);
+		const uint32_t dividend_hi = divided_part / divisor;
+		remainder = divided_part - (dividend_hi * divisor);
 
-	const unsigned int divisor = alphabet_len;
-	const unsigned int radix = BASEX_DIVISION_RADIX;
+		divided_part = (remainder << 16) | (limb & 0xFFFF);
+		const uint32_t dividend_lo = divided_part / divisor;
+		remainder = divided_part - (dividend_lo * divisor);
 
-	const unsigned int max_divisions = working_len * radix;
-	// const unsigned int max_divisions = 1;
-	unsigned int cur_divisions = 0;
-	bool empty_divided = dividedIsEmpty(divided,working_len);
-	while(!empty_divided) {
-		cur_divisions++;
+		*(limbs + limb_ix) = (dividend_hi << 16) | dividend_lo;
+	}
+	return remainder;
+}
+#else
+/**
+ * divides the limbs in place by a divisor of up to 32 bits, and returns the remainder.
+ * this needs a 64-bit division per limb, so it is only used where that is a native instruction.
+ */
+static uint32_t divide_limbs(uint32_t * limbs, const unsigned int limbs_len,
+                             const uint32_t divisor) {
+	uint64_t remainder = 0;
+	for(unsigned int limb_ix = 0; limb_ix < limbs_len; limb_ix++) {
+		const uint64_t divided_part = (remainder << 32) | *(limbs + limb_ix);
+		const uint64_t dividend = divided_part / divisor;
+		remainder = divided_part - (dividend * divisor);
+		*(limbs + limb_ix) = (uint32_t) dividend;
+	}
+	return (uint32_t) remainder;
+}
+#endif
 
-		if(cur_divisions > max_divisions) {
-			THROW(0x6D15);
+/**
+ * writes the digits of one chunk (a remainder of chunk_divisor) into out, least significant first, moving out_ix left.
+ * the zeros at the top of the last chunk are left to the padding, in case they don't fit.
+ * returns false if a digit does not fit in the output, unless suffix_only is set, in which case the digit is dropped.
+ */
+static bool write_chunk_digits(const char * alphabet, const unsigned int alphabet_len,
+                               uint32_t chunk, const unsigned int chunk_digits, const bool last_chunk,
+                               char * out, int * out_ix, const bool suffix_only) {
+	for(unsigned int c = 0; c < chunk_digits; c++) {
+		if(last_chunk && (chunk == 0)) {
+			break;
 		}
+		if(*out_ix < 0) {
+			return suffix_only;
+		}
+		*(out + *out_ix) = *(alphabet + (chunk % alphabet_len));
+		(*out_ix)--;
+		chunk /= alphabet_len;
+	}
+	return true;
+}
+
+/** divides the input in the scratch limbs by chunk_divisor until it is zero, writing the digits of each remainder into out. returns the new out_ix. */
+static int encode_chunks_software(const char * alphabet, const unsigned int alphabet_len,
+                                  const uint32_t chunk_divisor, const unsigned int chunk_digits,
+                                  const unsigned char * in, const unsigned int in_len,
+                                  char * out, int out_ix,
+                                  uint32_t * limbs, const unsigned int scratch_limbs,
+                                  const bool suffix_only) {
+	// if the input does not fit in the scratch, throw an error.
+	if(BASEX_SCRATCH_LIMBS(in_len) > scratch_limbs) {
+		THROW(0x6D12);
+	}
 
-		const unsigned int remainder =
-		    divide_and_remainder( divided,  working_len,
-		                          dividend, working_len,
-		                          divisor, radix,
-		                          enable_debug);
+	// the limbs are fully overwritten by load_limbs, so there is no need to clear them.
+	const unsigned int limbs_len = load_limbs(in, in_len, limbs);
 
-		if(remainder >= divisor) {
-			THROW(0x6D21);
-		}
+	// skip the leading zero limbs.
+	unsigned int limbs_start = 0;
+	while((limbs_start < limbs_len) && (limbs[limbs_start] == 0)) {
+		limbs_start++;
+	}
 
-		if(remainders_out_ix < 0) {
+	while((limbs_start < limbs_len) && !(suffix_only && (out_ix < 0))) {
+		const uint32_t chunk = divide_limbs(limbs + limbs_start, limbs_len - limbs_start, chunk_divisor);
+		if(limbs[limbs_start] == 0) {
+			limbs_start++;
+		}
+		if(!write_chunk_digits(alphabet, alphabet_len, chunk, chunk_digits, limbs_start == limbs_len,
+		                       out, &out_ix, suffix_only)) {
 			THROW(0x6D24);
 		}
-		*(remainders_out + remainders_out_ix) = remainder;
-
-		remainders_out_ix--;
-
-		memmove(divided, dividend, working_len);
-		working_len = remove_zeros(divided, working_len);
-		memset(dividend,0x00,sizeof(dividend));
+	}
+	return out_ix;
+}
 
-		empty_divided = dividedIsEmpty(divided,working_len);
+/**
+ * encodes in_length bytes from in into the given base, as out_len letters, left padded with the zero letter.
+ * each division pass divides by chunk_divisor (alphabet_len ^ chunk_digits) instead of alphabet_len,
+ * and the remainder is split into chunk_digits digits with 32-bit arithmetic,
+ * so a conversion takes 1/chunk_digits of the passes over the limbs.
+ * the leading zero bytes of the input are skipped, so the scratch only has to hold the significant bytes.
+ * if the output is too short, throw an error, unless suffix_only is set, in which case conversion stops
+ * once out_len digits are written, and the more significant digits are dropped.
+ */
+static unsigned int encode_base_chunked(const char * alphabet, const unsigned int alphabet_len,
+                                        const uint32_t chunk_divisor, const unsigned int chunk_digits,
+                                        const unsigned char * in, const unsigned int in_len_raw,
+                                        char * out, const unsigned int out_len,
+                                        uint32_t * scratch, const unsigned int scratch_limbs,
+                                        const bool suffix_only) {
+	unsigned int in_len = in_len_raw;
+	while((in_len > 0) && (*in == 0)) {
+		in++;
+		in_len--;
 	}
 
-	for(unsigned int c = 0; c < out_len; c++) {
-		unsigned char remainder_out = *(remainders_out + c);
-		*(out+c) = *(alphabet + remainder_out);
+	int out_ix = encode_chunks_software(alphabet, alphabet_len, chunk_divisor, chunk_digits,
+	                                    in, in_len, out, out_len - 1, scratch, scratch_limbs, suffix_only);
+
+	// pad the rest of the output with the zero letter.
+	while(out_ix >= 0) {
+		*(out + out_ix) = *alphabet;
+		out_ix--;
 	}
 	return out_len;
 }
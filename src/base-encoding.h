@@ -5,12 +5,95 @@
 #define BASE_ENCODING_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include "os.h"
+#include "hex.h"
 
+/** largest input the encode_base_* wrappers accept, they put this much scratch on the stack. */
 #define BASEX_DIVISION_BUFFER_SIZE 128
 
-#define BASEX_DIVISION_RADIX 256
+/** size of one limb of the division scratch, in bytes. */
+#define BASEX_LIMB_SIZE 4
+
+/** number of scratch limbs needed to divide in_length significant bytes. */
+#define BASEX_SCRATCH_LIMBS(in_length) (((in_length) + BASEX_LIMB_SIZE - 1) / BASEX_LIMB_SIZE)
+
+/** number of limbs in the encode_base_* wrappers' scratch. */
+#define BASEX_LIMB_COUNT BASEX_SCRATCH_LIMBS(BASEX_DIVISION_BUFFER_SIZE)
+
+/**
+ * none of the arm targets can divide 64 bits by 32 in hardware, a uint64_t division is a libgcc __aeabi_uldivmod call.
+ * there each limb is divided as two 16-bit halves in 32-bit arithmetic instead, which caps the chunk divisors at 16 bits.
+ * defining BASEX_HALF_LIMB_DIVIDE picks the same on a host, so the host tests can cover it.
+ */
+#if defined(__arm__) && !defined(BASEX_HALF_LIMB_DIVIDE)
+#define BASEX_HALF_LIMB_DIVIDE
+#endif
+
+#if defined(BASEX_HALF_LIMB_DIVIDE)
+/** largest power of ten that fits in a half limb, base-10 is converted this many digits at a time. */
+#define BASE_10_CHUNK_DIVISOR 10000
+
+/** number of base-10 digits in one BASE_10_CHUNK_DIVISOR chunk. */
+#define BASE_10_CHUNK_DIGITS 4
+
+/** number of base-58 digits converted per division pass, 58^2 is the largest power of 58 that fits in a half limb. */
+#define BASE_58_CHUNK_DIGITS 2
+
+/** bits of the value a chunk holds at least, in both base 10 and 58. */
+#define BASEX_CHUNK_MIN_BITS 11
+#else
+/** largest power of ten that fits in a limb, base-10 is converted this many digits at a time. */
+#define BASE_10_CHUNK_DIVISOR 1000000000
+
+/** number of base-10 digits in one BASE_10_CHUNK_DIVISOR chunk. */
+#define BASE_10_CHUNK_DIGITS 9
+
+/** number of base-58 digits converted per division pass, 58^5 is the largest power of 58 that fits in a limb. */
+#define BASE_58_CHUNK_DIGITS 5
+
+/** bits of the value a chunk holds at least, in both base 10 and 58. */
+#define BASEX_CHUNK_MIN_BITS 29
+#endif
+
+/** length of the longest base-58 encoding of in_length bytes, log(256)/log(58) is just under 1.366 digits per byte. */
+#define BASE_58_ENCODED_MAX_LEN(in_length) ((((in_length) * 1366) + 999) / 1000)
+
+/**
+ * number of scratch limbs encode_base_chunks needs for in_length significant bytes: the division limbs,
+ * plus one limb for each chunk of digits.
+ */
+#define BASEX_CHUNKS_SCRATCH_LIMBS(in_length) (BASEX_SCRATCH_LIMBS(in_length) + (((in_length) * 8) / BASEX_CHUNK_MIN_BITS) + 1)
+
+/**
+ * encodes in_length bytes from in into base 2, 10, 16, 32 or 58, writing out_length letters straight into out,
+ * left padded with the zero letter.
+ * base 10 and 58 divide in place in scratch, which must hold BASEX_SCRATCH_LIMBS of the input's significant bytes.
+ * the power of two bases need no scratch, and can be passed NULL.
+ * if the value needs more than out_length letters, throws an error, unless suffix_only is set,
+ * in which case only the least significant out_length letters are written.
+ */
+unsigned int encode_base_in_place(const unsigned int base,
+                                  const void *in, const unsigned int in_length,
+                                  char *out, const unsigned int out_length,
+                                  uint32_t *scratch, const unsigned int scratch_limbs,
+                                  const bool suffix_only);
+
+/**
+ * converts in_length bytes from in into base 10 or 58, without writing any letters yet.
+ * the chunks of digits are left at the top of scratch, which must hold BASEX_CHUNKS_SCRATCH_LIMBS of the input's significant bytes.
+ * returns the number of significant letters, at least one, which encode_base_stream then sends.
+ */
+unsigned int encode_base_chunks(const unsigned int base,
+                                const void *in, const unsigned int in_length,
+                                uint32_t *scratch, const unsigned int scratch_limbs);
+
+/** passes the letters_len significant letters converted by encode_base_chunks to sink, most significant first, a chunk at a time. */
+void encode_base_stream(const unsigned int base,
+                        const uint32_t *scratch, const unsigned int scratch_limbs,
+                        const unsigned int letters_len,
+                        text_sink_t sink, void *context);
 
 /** encodes in_length bytes from in into base-2, writes the converted bytes to out, stopping when it converts out_length bytes.  */
 unsigned int encode_base_2(const void *in, const unsigned int in_length,
@@ -32,8 +115,13 @@ unsigned int encode_base_32(const void *in, const unsigned int in_length,
                             char *out, const unsigned int out_length,
                             const bool enable_debug);
 
+/** encodes in_length bytes from in into base-58, writes the converted bytes to out, stopping when it converts out_length bytes.  */
 unsigned int encode_base_58(const void *in, const unsigned int in_length,
                             char *out, const unsigned int out_length,
                             const bool enable_debug);
 
-#endif // BANANO_H
+/** encodes in_length bytes from in into base-58, writes only the least significant out_length letters to out, left padded if the value is shorter.  */
+unsigned int encode_base_58_suffix(const void *in, const unsigned int in_length,
+                                   char *out, const unsigned int out_length);
+
+#endif // BASE_ENCODING_H
@@ -4,6 +4,8 @@
 #include "constellation.h"
 #include "base-encoding.h"
 #include "shared.h"
+#include "selector.h"
+#include "decoder.h"
 
 /** length of the checksum used to convert a tx.output.script_hash into an Address. */
 #define SCRIPT_HASH_CHECKSUM_LEN 4
@@ -27,11 +29,7 @@ void display_no_public_key() {
 	publicKeyNeedsRefresh = 0;
 }
 
-void display_public_key(const unsigned char * public_key) {
-	memmove(current_public_key[0], TXT_BLANK, sizeof(TXT_BLANK));
-	memmove(current_public_key[1], TXT_BLANK, sizeof(TXT_BLANK));
-	memmove(current_public_key[2], TXT_BLANK, sizeof(TXT_BLANK));
-
+void public_key_address(const unsigned char * public_key, char * address) {
 	unsigned char public_key_encoded[PUBLIC_KEY_ENCODED_LEN];
 	memmove(public_key_encoded, PUBLIC_KEY_PREFIX, PUBLIC_KEY_PREFIX_LEN);
 	memmove(public_key_encoded + PUBLIC_KEY_PREFIX_LEN, public_key, PUBLIC_KEY_LEN);
@@ -39,11 +37,11 @@ void display_public_key(const unsigned char * public_key) {
 	unsigned char address_hash_result[CX_SHA256_SIZE];
 	cx_hash_sha256(public_key_encoded, PUBLIC_KEY_ENCODED_LEN, address_hash_result, CX_SHA256_SIZE);
 
-	char base58_encoded[BASE58_ENCODED_ADDRESS_LEN];
-	encode_base_58(address_hash_result, CX_SHA256_SIZE, base58_encoded, BASE58_ENCODED_ADDRESS_LEN, false);
-
+	// only the least significant letters of the base58 encoding are used for the address.
 	char end[BASE58_ENCODED_ADDRESS_SUFFIX_LEN];
-	memmove(end, base58_encoded + BASE58_ENCODED_ADDRESS_LEN - BASE58_ENCODED_ADDRESS_SUFFIX_LEN, BASE58_ENCODED_ADDRESS_SUFFIX_LEN);
+	uint32_t scratch[BASEX_SCRATCH_LIMBS(CX_SHA256_SIZE)];
+	encode_base_in_place(58, address_hash_result, CX_SHA256_SIZE, end, BASE58_ENCODED_ADDRESS_SUFFIX_LEN,
+	                     scratch, BASEX_SCRATCH_LIMBS(CX_SHA256_SIZE), true);
 
 	int sum = 0;
 	for(int i = 0; i < BASE58_ENCODED_ADDRESS_SUFFIX_LEN; i++) {
@@ -57,16 +55,22 @@ void display_public_key(const unsigned char * public_key) {
 	char par[1];
 	par[0] = '0' + (sum % 9);
 
-	char address[ADDRESS_LEN];
 	memmove(address, ADDRESS_PREFIX, 3);
 	memmove(address + 3, par, 1);
 	memmove(address + 4, end, BASE58_ENCODED_ADDRESS_SUFFIX_LEN);
+}
+
+void display_address(const char * address) {
+	memmove(current_public_key[0], TXT_BLANK, sizeof(TXT_BLANK));
+	memmove(current_public_key[1], TXT_BLANK, sizeof(TXT_BLANK));
+	memmove(current_public_key[2], TXT_BLANK, sizeof(TXT_BLANK));
+
 	unsigned int address_len_0 = 13;
 	unsigned int address_len_1 = 13;
 	unsigned int address_len_2 = 14;
-	char * address_0 = address;
-	char * address_1 = address + address_len_0;
-	char * address_2 = address + address_len_0 + address_len_1;
+	const char * address_0 = address;
+	const char * address_1 = address + address_len_0;
+	const char * address_2 = address + address_len_0 + address_len_1;
 
 	memmove(current_public_key[0], address_0, address_len_0);
 	memmove(current_public_key[1], address_1, address_len_1);
@@ -74,116 +78,145 @@ void display_public_key(const unsigned char * public_key) {
 	publicKeyNeedsRefresh = 0;
 }
 
-void add_hex_data_to_hash(unsigned char * in, const unsigned int len) {
-	char dest[2];
-	for(unsigned int copy_ix = 0; copy_ix < len; copy_ix++) {
-		memset(dest, 0x00, sizeof(dest));
-		to_hex(dest, in + copy_ix, sizeof(dest));
-		if(hash_data_ix + 2 > HASH_DATA_SIZE) {
-			THROW(0x6D33);
-		}
-		hash_data[hash_data_ix + 0] = dest[0];
-		hash_data[hash_data_ix + 1] = dest[1];
-		hash_data_ix += 2;
-	}
+void display_public_key(const unsigned char * public_key) {
+	char address[ADDRESS_LEN];
+	public_key_address(public_key, address);
+	display_address(address);
 }
 
-void add_data_to_hash(unsigned char * in, const unsigned int len) {
-	for(unsigned int copy_ix = 0; copy_ix < len; copy_ix++) {
-		if(hash_data_ix + copy_ix > HASH_DATA_SIZE) {
-			THROW(0x6D34);
-		}
-		hash_data[hash_data_ix + copy_ix] = *(in + copy_ix);
-	}
-	hash_data_ix += len;
+bool tx_streamed;
+
+const kryo_schema_t * tx_schema;
+
+/** running sha256 of a streamed transaction, from its kryo header on. */
+static cx_sha256_t tx_stream_hash;
+
+/** kryo text length the host declared for a streamed transaction, which its header was hashed with. */
+static unsigned int tx_stream_text_len;
+
+/** bip44 path of a streamed transaction, the bytes after its last field. */
+static unsigned char tx_stream_bip44[BIP44_BYTE_LENGTH];
+
+/** bytes of tx_stream_bip44 received so far. */
+static unsigned int tx_stream_bip44_len;
+
+/** views in tx_fields that have been sized and selected for display so far. */
+static unsigned int tx_fields_parsed;
+
+/** length of the kryo text of the views parsed so far. */
+static unsigned int tx_fields_text_len;
+
+/** text sink that adds the letters to the sha256 context. */
+static void sha256_text_sink(void * context, const char * text, const unsigned int text_len) {
+	cx_hash((cx_hash_t *)context, 0, (const unsigned char *)text, text_len, NULL, 0);
 }
 
-void add_number_to_hash(const unsigned char number) {
-	if(number > 99) {
-		THROW(0x6D32);
-	}
-	if(number < 10) {
-		if(hash_data_ix + 1 > HASH_DATA_SIZE) {
-			THROW(0x6D35);
-		}
-		hash_data[hash_data_ix++] = '0' + (number % 10);
-	} else {
-		if(hash_data_ix + 2 > HASH_DATA_SIZE) {
-			THROW(0x6D36);
-		}
-		hash_data[hash_data_ix++] = '0' + (number/10);
-		hash_data[hash_data_ix++] = '0' + (number % 10);
+/** sizes and selects for display the views the decoder added since the last call. */
+static void parse_new_fields(void) {
+	while(tx_fields_parsed < tx_fields_len) {
+		const tx_field_view_t * view = tx_fields + tx_fields_parsed;
+		tx_fields_text_len += kryo_serialize(raw_tx, view, 1, NULL, NULL);
+		select_display_field(raw_tx, view);
+		tx_fields_parsed++;
 	}
 }
 
-void add_base10_and_len_to_hash(unsigned char * in, const unsigned int len) {
-	char base10[MAX_TX_TEXT_WIDTH];
-	unsigned int base10_len = encode_base_10(in, len, base10, MAX_TX_TEXT_WIDTH-1, false);
-	unsigned int base10_start = 0;
-	while((base10[base10_start] == '0') && (base10_start < base10_len-1)) {
-		base10_start++;
+/** returns the end of the transaction fields in raw_tx, which is followed by the bip44 path. */
+static unsigned int fields_end(void) {
+	if(raw_tx_len < BIP44_BYTE_LENGTH) {
+		THROW(0x6D37);
 	}
-	unsigned int base10_true_len = base10_len-base10_start;
-	add_number_to_hash(base10_true_len);
-	add_data_to_hash((unsigned char *)base10 + base10_start, base10_true_len);
+	return raw_tx_len - BIP44_BYTE_LENGTH;
+}
+
+void tx_parse_begin(const kryo_schema_t * schema) {
+	decode_begin(schema);
+	tx_schema = schema;
+	tx_streamed = false;
+	tx_fields_parsed = 0;
+	tx_fields_text_len = 0;
+	select_display_begin();
+}
+
+void tx_parse_chunk(const unsigned int end) {
+	decode_fields(end);
+	parse_new_fields();
 }
 
-void add_base16_and_len_to_hash(unsigned char * in, const unsigned int len) {
-	char base16[MAX_TX_TEXT_WIDTH*2];
-	unsigned int base16_len = encode_base_16(in, len, base16, sizeof(base16)-1, false);
-	unsigned int base16_start = 0;
-	while((base16[base16_start] == '0') && (base16_start < base16_len-1)) {
-		base16_start++;
+void tx_parse_end(void) {
+	const unsigned int end = fields_end();
+	decode_fields(end);
+
+	// a field decoded from an earlier chunk may have run into what turned out to be the bip44 path.
+	if(!decode_complete(end)) {
+		THROW(0x6D37);
 	}
-	unsigned int base16_true_len = base16_len-base16_start;
-	add_number_to_hash(base16_true_len);
-	add_data_to_hash((unsigned char *)base16 + base16_start, base16_true_len);
+	parse_new_fields();
+	select_display_end();
+	tx_text_len = tx_fields_text_len;
 }
 
-void calc_hash(void) {
+/** hashes and selects for display one field as it streams in. */
+static void stream_field(const unsigned char * tx, const tx_field_view_t * view) {
+	tx_fields_text_len += kryo_serialize(tx, view, 1, sha256_text_sink, &tx_stream_hash);
+	select_display_field(tx, view);
+}
 
-	// decoding hash
-	memset(hash_data, 0x00, sizeof(hash_data));
-	hash_data_ix = 0;
+void tx_stream_begin(const kryo_schema_t * schema, const unsigned int text_len) {
+	tx_parse_begin(schema);
+	tx_streamed = true;
+	tx_stream_text_len = text_len;
+	tx_stream_bip44_len = 0;
 
-	unsigned int ix = 0;
+	unsigned char header[KRYO_HEADER_MAX_LEN];
+	unsigned int header_len = kryo_header(tx_schema, header, text_len);
+	cx_sha256_init(&tx_stream_hash);
+	cx_hash((cx_hash_t *)&tx_stream_hash, 0, header, header_len, NULL, 0);
+}
+
+void tx_stream_chunk(const unsigned char * in, const unsigned int in_len) {
+	const unsigned int fields_len = decode_stream(in, in_len, stream_field);
+
+	// whatever follows the last field is the bip44 path.
+	const unsigned int path_len = in_len - fields_len;
+	if(path_len > BIP44_BYTE_LENGTH - tx_stream_bip44_len) {
+		THROW(0x6D37);
+	}
+	memmove(tx_stream_bip44 + tx_stream_bip44_len, in + fields_len, path_len);
+	tx_stream_bip44_len += path_len;
+}
 
-	// *** decoding parents ***
-	unsigned int maxParents = raw_tx[ix++];
-	// add num parents to hash
-	add_number_to_hash(maxParents);
+void tx_stream_end(void) {
+	if(!decode_stream_complete() || (tx_stream_bip44_len != BIP44_BYTE_LENGTH)) {
+		THROW(0x6D37);
+	}
+	// the header was hashed with the declared length, before any of the text.
+	if(tx_fields_text_len != tx_stream_text_len) {
+		THROW(0x6D3B);
+	}
+	select_display_end();
+	tx_text_len = tx_fields_text_len;
+	cx_hash((cx_hash_t *)&tx_stream_hash, CX_LAST, NULL, 0, tx_hash, sizeof(tx_hash));
+}
 
-	for(unsigned int parentIx = 0; parentIx < maxParents; parentIx++) {
-		unsigned int parentLen = raw_tx[ix++];
-		// add parent length to hash
-		add_number_to_hash(parentLen);
-		// add parent to hash
-		add_data_to_hash(raw_tx + ix, parentLen);
-		ix += parentLen;
+const unsigned char * tx_bip44_path(void) {
+	if(tx_streamed) {
+		return tx_stream_bip44;
 	}
+	return raw_tx + raw_tx_len - BIP44_BYTE_LENGTH;
+}
 
-	// // *** decoding amount ***
-	unsigned int amountLen = raw_tx[ix++];
-	add_base16_and_len_to_hash(raw_tx + ix, amountLen);
-	ix += amountLen;
-
-	// *** decoding lastTxRefHash
-	unsigned int lastTxRefHashLen = raw_tx[ix++];
-	add_number_to_hash(lastTxRefHashLen);
-	add_data_to_hash(raw_tx + ix, lastTxRefHashLen);
-	ix += lastTxRefHashLen;
-
-	// *** decoding lastTxRefOrdinal
-	unsigned int lastTxRefOrdinalLen = raw_tx[ix++];
-	add_base10_and_len_to_hash(raw_tx + ix, lastTxRefOrdinalLen);
-	ix += lastTxRefOrdinalLen;
-
-	// *** decoding fee
-	unsigned int feeLen = raw_tx[ix++];
-	add_base10_and_len_to_hash(raw_tx + ix, feeLen);
-	ix += feeLen;
-
-	// *** decoding salt
-	unsigned int saltLen = raw_tx[ix++];
-	add_base16_and_len_to_hash(raw_tx + ix, saltLen);
+unsigned int serialize_tx(text_sink_t sink, void * context) {
+	return kryo_serialize(raw_tx, tx_fields, tx_fields_len, sink, context);
+}
+
+void calc_hash(void) {
+	unsigned char header[KRYO_HEADER_MAX_LEN];
+	unsigned int header_len = kryo_header(tx_schema, header, tx_text_len);
+
+	cx_sha256_t hash_context_256;
+	cx_sha256_init(&hash_context_256);
+	cx_hash((cx_hash_t *)&hash_context_256, 0, header, header_len, NULL, 0);
+	serialize_tx(sha256_text_sink, &hash_context_256);
+	cx_hash((cx_hash_t *)&hash_context_256, CX_LAST, NULL, 0, tx_hash, sizeof(tx_hash));
 }
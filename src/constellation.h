@@ -10,9 +10,8 @@
 #include "cx.h"
 #include <stdbool.h>
 #include "ui.h"
-
-/** length of the public key */
-#define PUBLIC_KEY_LEN 65
+#include "shared.h"
+#include "kryo.h"
 
 /** length of the public key prefix */
 #define PUBLIC_KEY_PREFIX_LEN 23
@@ -20,25 +19,55 @@
 /** length of the encoded public key */
 #define PUBLIC_KEY_ENCODED_LEN PUBLIC_KEY_PREFIX_LEN + PUBLIC_KEY_LEN
 
-/** length of the base58 encoding of the public key */
-#define BASE58_ENCODED_ADDRESS_LEN 120
+extern unsigned char public_key_encoded[33];
 
-/** length of the suffix of the base58 key used for the address */
-#define BASE58_ENCODED_ADDRESS_SUFFIX_LEN 36
+extern unsigned char address[ADDRESS_LEN];
 
-/** length of a tx.output Address before encoding, which is the length of <address_version>+<script_hash>+<checksum> */
-#define ADDRESS_LEN BASE58_ENCODED_ADDRESS_SUFFIX_LEN + 4
+/** set when the transaction was hashed as it streamed in, so only its hash and its bip44 path are kept. */
+extern bool tx_streamed;
 
-extern unsigned char public_key_encoded[33];
+/** layout of the transaction being signed, set by tx_parse_begin or tx_stream_begin. */
+extern const kryo_schema_t * tx_schema;
 
-extern unsigned char address[ADDRESS_LEN];
+/** resets the decoder and the screens, for the first chunk of a transaction laid out as in schema. */
+void tx_parse_begin(const kryo_schema_t * schema);
+
+/** decodes, sizes and selects for display the fields that have fully arrived in the first end bytes of raw_tx. */
+void tx_parse_chunk(const unsigned int end);
 
-/** calculates the hash based on the tx */
+/** parses the rest of the fields once raw_tx_len is set, checks they end at the bip44 path, and sets tx_text_len. */
+void tx_parse_end(void);
+
+/** hashes the kryo serialization of the parsed tx into tx_hash, using the tx_text_len from tx_parse_end. */
 void calc_hash(void);
 
+/**
+ * resets the decoder and the screens for a transaction that is hashed as it streams in, without being kept in raw_tx.
+ * the kryo header comes ahead of the text, so the host declares the text length, text_len, up front.
+ */
+void tx_stream_begin(const kryo_schema_t * schema, const unsigned int text_len);
+
+/** hashes and selects for display the fields in in_len bytes of in, a chunk of a streamed transaction, read in place. */
+void tx_stream_chunk(const unsigned char * in, const unsigned int in_len);
+
+/** checks every field and the bip44 path arrived, and the text came out the declared length, then sets tx_hash and tx_text_len. */
+void tx_stream_end(void);
+
+/** returns the bip44 path that follows the transaction fields. */
+const unsigned char * tx_bip44_path(void);
+
+/** sends the kryo text serialization of the fields decoded from raw_tx to sink, not for a streamed tx. a NULL sink only measures it. returns the text length. */
+unsigned int serialize_tx(text_sink_t sink, void * context);
+
 /** displays the "no public key" message, prior to a public key being requested. */
 void display_no_public_key(void);
 
+/** writes the ADDRESS_LEN letter DAG address of the public key, assumed 65 bytes long, into address, without a NUL. */
+void public_key_address(const unsigned char * public_key, char * address);
+
+/** displays the ADDRESS_LEN letter DAG address, split across the three lines of the public key screen. */
+void display_address(const char * address);
+
 /** displays the public key, assumes length is 65. */
 void display_public_key(const unsigned char * public_key);
 
@@ -0,0 +1,143 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+#include "decoder.h"
+#include "os.h"
+#include <string.h>
+
+tx_field_view_t tx_fields[MAX_TX_FIELDS];
+
+unsigned int tx_fields_len;
+
+tx_decoder_t tx_decoder;
+
+/** a field held back from the last chunk, its length byte and up to 255 bytes, fits in raw_tx, or the build fails. */
+typedef char decoder_carry_fits[(MAX_TX_RAW_LENGTH >= 1 + 0xFF) ? 1 : -1];
+
+void decode_begin(const kryo_schema_t * schema) {
+	memset(tx_fields, 0x00, sizeof(tx_fields));
+	tx_fields_len = 0;
+	memset(&tx_decoder, 0x00, sizeof(tx_decoder));
+	tx_decoder.schema = schema;
+}
+
+/** moves the decoder past the schema field it just decoded, a count of len sets how often the next field repeats. */
+static void next_field(const kryo_field_t * schema_field, const unsigned int len) {
+	if(schema_field->encoding == KRYO_COUNT) {
+		tx_decoder.repeats_left = len;
+		tx_decoder.schema_ix++;
+		// a count of zero skips the counted field entirely.
+		if(len == 0) {
+			tx_decoder.schema_ix++;
+		}
+	} else if(tx_decoder.repeats_left > 1) {
+		tx_decoder.repeats_left--;
+	} else {
+		tx_decoder.repeats_left = 0;
+		tx_decoder.schema_ix++;
+	}
+}
+
+/** returns true once the decoder is past the last field in the schema. */
+static bool schema_done(void) {
+	return tx_decoder.schema_ix == tx_decoder.schema->fields_len;
+}
+
+/** checks a field's length byte against the schema. */
+static void check_field_len(const kryo_field_t * schema_field, const unsigned int len) {
+	if(len > schema_field->max_len) {
+		THROW((schema_field->encoding == KRYO_COUNT) ? 0x6D39 : 0x6D3A);
+	}
+}
+
+void decode_fields(const unsigned int end) {
+	while(!schema_done() && (tx_decoder.ix < end)) {
+		const kryo_field_t * schema_field = tx_decoder.schema->fields + tx_decoder.schema_ix;
+		const unsigned int len = raw_tx[tx_decoder.ix];
+
+		// a count is the length byte alone.
+		unsigned int field_len = 1;
+		if(schema_field->encoding != KRYO_COUNT) {
+			if(len > end - tx_decoder.ix - 1) {
+				return;
+			}
+			field_len += len;
+		}
+		check_field_len(schema_field, len);
+		if(tx_fields_len >= MAX_TX_FIELDS) {
+			THROW(0x6D39);
+		}
+
+		tx_field_view_t * view = tx_fields + tx_fields_len;
+		view->field = schema_field->field;
+		view->encoding = schema_field->encoding;
+		view->len = len;
+		view->offset = tx_decoder.ix + 1;
+		tx_fields_len++;
+
+		tx_decoder.ix += field_len;
+		next_field(schema_field, len);
+	}
+}
+
+bool decode_complete(const unsigned int end) {
+	return schema_done() && (tx_decoder.ix <= end);
+}
+
+/** hands one streamed field to sink, and moves on to the next schema field. */
+static void stream_field(const kryo_field_t * schema_field, const unsigned char * tx, const unsigned int offset, const unsigned int len, tx_field_sink_t sink) {
+	tx_field_view_t view;
+	view.field = schema_field->field;
+	view.encoding = schema_field->encoding;
+	view.len = len;
+	view.offset = offset;
+	sink(tx, &view);
+	next_field(schema_field, len);
+}
+
+unsigned int decode_stream(const unsigned char * in, const unsigned int in_len, tx_field_sink_t sink) {
+	unsigned int ix = 0;
+	while(!schema_done() && (ix < in_len)) {
+		const kryo_field_t * schema_field = tx_decoder.schema->fields + tx_decoder.schema_ix;
+
+		// finish the field held back from the last chunk.
+		if(tx_decoder.carry_len > 0) {
+			const unsigned int carry_end = 1 + raw_tx[0];
+			unsigned int take = carry_end - tx_decoder.carry_len;
+			if(take > in_len - ix) {
+				take = in_len - ix;
+			}
+			memmove(raw_tx + tx_decoder.carry_len, in + ix, take);
+			tx_decoder.carry_len += take;
+			ix += take;
+			if(tx_decoder.carry_len == carry_end) {
+				tx_decoder.carry_len = 0;
+				stream_field(schema_field, raw_tx, 1, raw_tx[0], sink);
+			}
+			continue;
+		}
+
+		const unsigned int len = in[ix];
+		check_field_len(schema_field, len);
+
+		// a count is the length byte alone.
+		if(schema_field->encoding == KRYO_COUNT) {
+			ix++;
+			stream_field(schema_field, in, ix, len, sink);
+		} else if(len < in_len - ix) {
+			stream_field(schema_field, in, ix + 1, len, sink);
+			ix += 1 + len;
+		} else {
+			// the field runs into the next chunk, hold back what there is of it.
+			tx_decoder.carry_len = in_len - ix;
+			memmove(raw_tx, in + ix, tx_decoder.carry_len);
+			ix = in_len;
+		}
+	}
+	return ix;
+}
+
+bool decode_stream_complete(void) {
+	return schema_done() && (tx_decoder.carry_len == 0);
+}
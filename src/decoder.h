@@ -0,0 +1,66 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <stdbool.h>
+#include "kryo.h"
+
+/** most fields in the view table, the parent count, the parents, and the five fields after them. */
+#define MAX_TX_FIELDS (MAX_TX_PARENTS + 6)
+
+/** most bytes of a field held back when it is split across chunks, its length byte and up to 255 bytes of data. */
+#define TX_CARRY_LEN (1 + 0xFF)
+
+/** receives each field decoded by decode_stream, the view's offset is into tx. */
+typedef void (*tx_field_sink_t)(const unsigned char * tx, const tx_field_view_t * view);
+
+/** how far the decoder has got through the transaction in raw_tx. */
+typedef struct {
+	/** the layout of the transaction. */
+	const kryo_schema_t * schema;
+	/** index in the schema of the next field to decode. */
+	unsigned int schema_ix;
+	/** number of times the next field repeats, after a count, including this one. */
+	unsigned int repeats_left;
+	/** offset in raw_tx of the next field's length byte. */
+	unsigned int ix;
+	/** when streaming, bytes of a field split across chunks held in raw_tx so far, starting with its length byte. */
+	unsigned int carry_len;
+} tx_decoder_t;
+
+/** views of the decoded fields, in the order they appear in raw_tx. */
+extern tx_field_view_t tx_fields[MAX_TX_FIELDS];
+
+/** number of views in tx_fields. */
+extern unsigned int tx_fields_len;
+
+/** the decoder's progress through raw_tx. */
+extern tx_decoder_t tx_decoder;
+
+/** clears the view table, for a new transaction laid out as in schema, decoded from raw_tx or streamed. */
+void decode_begin(const kryo_schema_t * schema);
+
+/**
+ * decodes the fields that lie entirely before end in raw_tx, starting where the decoder left off,
+ * and appends their views to tx_fields. stops at the first field that is not all there yet.
+ */
+void decode_fields(const unsigned int end);
+
+/** returns true once every field is decoded, and none of them runs past end. */
+bool decode_complete(const unsigned int end);
+
+/**
+ * decodes fields straight out of in_len bytes of in, a chunk of the transaction, handing each to sink as it completes.
+ * a field wholly inside the chunk is read in place. only a field split across chunks is held back, in raw_tx,
+ * until the rest of it arrives. nothing is added to tx_fields.
+ * returns the number of bytes used, which is less than in_len once the last field is decoded.
+ */
+unsigned int decode_stream(const unsigned char * in, const unsigned int in_len, tx_field_sink_t sink);
+
+/** returns true once every field has been streamed, and none is partly held back. */
+bool decode_stream_complete(void);
+
+#endif // DECODER_H
@@ -2,92 +2,120 @@
  * MIT License, see root folder for full license.
  */
 
-#include "base-encoding.h"
+#include "format.h"
 #include "os.h"
-#include "shared.h"
 
-#define DECIMAL_PLACE_OFFSET 8
+/** longest uint64 in decimal. */
+#define UINT64_MAX_DIGITS 20
 
-static const char TXT_LOW_VALUE[] = "Low Value\0";
+/** powers of ten, POWERS_OF_TEN[n] is the smallest value with n+1 digits. */
+static const uint64_t POWERS_OF_TEN[UINT64_MAX_DIGITS] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+	10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+	1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL,
+	10000000000000000000ULL
+};
 
-static const char TXT_PERIOD[] = ".";
+/** decodes a big-endian value, throws an error if it has more than eight significant bytes. */
+static uint64_t decode_uint64_be(const unsigned char *value, const unsigned int value_len)
+{
+	uint64_t decoded = 0;
+	for (unsigned int ix = 0; ix < value_len; ix++)
+	{
+		if ((decoded >> 56) != 0)
+		{
+			THROW(0x6D26);
+		}
+		decoded = (decoded << 8) | value[ix];
+	}
+	return decoded;
+}
 
-static void to_base10_100m(const unsigned char *value, const unsigned int value_len, char *dest)
+unsigned int format_fixed_point(const uint64_t value, const unsigned int decimals,
+                                const bool grouping, const bool trim_trailing_zeros,
+                                char *dest, const unsigned int dest_len)
 {
+	uint64_t remaining = value;
+	unsigned int fraction_digits = decimals;
+	if (trim_trailing_zeros)
+	{
+		while ((fraction_digits > 0) && ((remaining % 10) == 0))
+		{
+			remaining /= 10;
+			fraction_digits--;
+		}
+	}
 
-	// encode in base10
-	char base10_buffer[MAX_TX_TEXT_WIDTH];
-	unsigned int buffer_len = encode_base_10(value, value_len, base10_buffer, MAX_TX_TEXT_WIDTH - 1, false);
+	// a value below one still gets a zero before the decimal point.
+	unsigned int digits = 1;
+	while ((digits < UINT64_MAX_DIGITS) && (remaining >= POWERS_OF_TEN[digits]))
+	{
+		digits++;
+	}
+	if (digits <= fraction_digits)
+	{
+		digits = fraction_digits + 1;
+	}
+	const unsigned int whole_digits = digits - fraction_digits;
 
-	// place the decimal place.
-	unsigned int dec_place_ix = buffer_len - DECIMAL_PLACE_OFFSET;
-	if (buffer_len < DECIMAL_PLACE_OFFSET)
+	unsigned int len = digits;
+	if (fraction_digits > 0)
 	{
-		memmove(dest, TXT_LOW_VALUE, sizeof(TXT_LOW_VALUE));
+		len++;
 	}
-	else
+	if (grouping)
 	{
-		memcpy(dest + dec_place_ix, TXT_PERIOD, sizeof(TXT_PERIOD));
-		memcpy(dest, base10_buffer, dec_place_ix);
-		memmove(dest + dec_place_ix + 1, base10_buffer + dec_place_ix, buffer_len - dec_place_ix);
+		len += (whole_digits - 1) / 3;
+	}
+	if (len >= dest_len)
+	{
+		return 0;
 	}
-}
 
-static void remove_leading_zeros(unsigned int scr_ix, unsigned int line_ix)
-{
-	unsigned char found_nonzero = 0;
-	unsigned int nonzero_ix = 0;
-	for (unsigned int zero_ix = 0; (zero_ix < MAX_TX_TEXT_WIDTH - 1) && (found_nonzero == 0); zero_ix++)
+	// write from the least significant digit, so each digit is written once.
+	unsigned int dest_ix = len;
+	dest[dest_ix] = '\0';
+	for (unsigned int ix = 0; ix < fraction_digits; ix++)
 	{
-		nonzero_ix = zero_ix;
-		if (tx_desc[scr_ix][line_ix][zero_ix] != '0')
-		{
-			found_nonzero = 1;
-		}
+		dest[--dest_ix] = '0' + (remaining % 10);
+		remaining /= 10;
+	}
+	if (fraction_digits > 0)
+	{
+		dest[--dest_ix] = '.';
 	}
-	if (nonzero_ix > 0)
+	for (unsigned int ix = 0; ix < whole_digits; ix++)
 	{
-		for (unsigned int ix = 0; ix < MAX_TX_TEXT_WIDTH; ix++)
+		if (grouping && (ix > 0) && ((ix % 3) == 0))
 		{
-			if (ix <= MAX_TX_TEXT_WIDTH - nonzero_ix)
-			{
-				tx_desc[scr_ix][line_ix][ix] = tx_desc[scr_ix][line_ix][ix + nonzero_ix];
-			}
-			else
-			{
-				tx_desc[scr_ix][line_ix][ix] = '\0';
-			}
+			dest[--dest_ix] = ',';
 		}
+		dest[--dest_ix] = '0' + (remaining % 10);
+		remaining /= 10;
 	}
+	return len;
 }
 
-void format_display_values(void)
+void format_display_value(const unsigned int scr_ix, const unsigned char *value, const unsigned int value_len,
+                          const unsigned int decimals)
 {
+	const uint64_t decoded = decode_uint64_be(value, value_len);
 
-	// Format the Amount
-	unsigned char amountTemp[sizeof(tx_desc[2][1])];
-	unsigned int amountLength = tx_desc[2][2][0] - '0';
-
-	memmove(amountTemp, tx_desc[2][1], sizeof(tx_desc[2][1]));
-	memset(tx_desc[2][1], 0x00, sizeof(tx_desc[2][1]));
-	memset(tx_desc[2][2], 0x00, sizeof(tx_desc[2][2]));
-
-	memmove(tx_desc[2][2], TXT_BLANK, sizeof(TXT_BLANK));
-
-	to_base10_100m(amountTemp, amountLength, tx_desc[2][1]);
-	remove_leading_zeros(2, 1);
+	memset(tx_desc[scr_ix][1], 0x00, sizeof(tx_desc[scr_ix][1]));
+	memset(tx_desc[scr_ix][2], 0x00, sizeof(tx_desc[scr_ix][2]));
 
-	// Format the Fee
-	unsigned char feeTemp[sizeof(tx_desc[3][1])];
-	unsigned int feeLength = tx_desc[3][2][0] - '0';
-
-	memmove(feeTemp, tx_desc[3][1], sizeof(tx_desc[3][1]));
-
-	memset(tx_desc[3][1], 0x00, sizeof(tx_desc[3][1]));
-	memset(tx_desc[3][2], 0x00, sizeof(tx_desc[3][2]));
-
-	memmove(tx_desc[3][2], TXT_BLANK, sizeof(TXT_BLANK));
+	if (format_fixed_point(decoded, decimals, false, false, tx_desc[scr_ix][1], MAX_TX_TEXT_WIDTH) != 0)
+	{
+		return;
+	}
 
-	encode_base_10(feeTemp, feeLength, tx_desc[3][1], MAX_TX_TEXT_WIDTH - 1, false);
-	remove_leading_zeros(3, 1);
-}
\ No newline at end of file
+	// too wide for the screen, wrap onto line 2.
+	char wrapped[MAX_TX_TEXT_WIDTH * 2];
+	unsigned int wrapped_len = format_fixed_point(decoded, decimals, false, false, wrapped, sizeof(wrapped));
+	if (wrapped_len == 0)
+	{
+		THROW(0x6D26);
+	}
+	memcpy(tx_desc[scr_ix][1], wrapped, MAX_TX_TEXT_WIDTH - 1);
+	memcpy(tx_desc[scr_ix][2], wrapped + MAX_TX_TEXT_WIDTH - 1, wrapped_len - (MAX_TX_TEXT_WIDTH - 1));
+}
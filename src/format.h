@@ -1,9 +1,25 @@
-
 /*
  * MIT License, see root folder for full license.
  */
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
 #include "shared.h"
 
-/* Formats the values that will be displayed to the user */
-void format_display_values(void);
\ No newline at end of file
+/**
+ * writes value scaled down by 10^decimals into dest as decimal text, with a NUL terminator.
+ * grouping puts a ',' between each three whole digits, trim_trailing_zeros drops the zeros at the end of the fraction,
+ * and the decimal point if nothing is left after it.
+ * returns the text length, or 0 if the text and terminator do not fit in dest_len.
+ */
+unsigned int format_fixed_point(const uint64_t value, const unsigned int decimals,
+                                const bool grouping, const bool trim_trailing_zeros,
+                                char *dest, const unsigned int dest_len);
+
+/**
+ * formats value_len big-endian bytes of value, scaled down by 10^decimals, onto line 1 of the screen,
+ * wrapping onto line 2 if it is wider than the screen. throws an error if it does not fit both lines.
+ */
+void format_display_value(const unsigned int scr_ix, const unsigned char *value, const unsigned int value_len,
+                          const unsigned int decimals);
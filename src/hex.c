@@ -1,16 +1,129 @@
+/*
+ * MIT License, see root folder for full license.
+ */
 
+#include "hex.h"
 
-/** array of capital letter hex values */
-static const char HEX_CAP[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F', };
+/** the two lower case hex letters of every byte value. */
+const char HEX_PAIRS_LOWER[] =
+	"000102030405060708090a0b0c0d0e0f"
+	"101112131415161718191a1b1c1d1e1f"
+	"202122232425262728292a2b2c2d2e2f"
+	"303132333435363738393a3b3c3d3e3f"
+	"404142434445464748494a4b4c4d4e4f"
+	"505152535455565758595a5b5c5d5e5f"
+	"606162636465666768696a6b6c6d6e6f"
+	"707172737475767778797a7b7c7d7e7f"
+	"808182838485868788898a8b8c8d8e8f"
+	"909192939495969798999a9b9c9d9e9f"
+	"a0a1a2a3a4a5a6a7a8a9aaabacadaeaf"
+	"b0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+	"c0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+	"d0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+	"e0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+	"f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
 
-/** converts a byte array in src to a hex array in dest, using only dest_len bytes of dest before stopping. */
+/** the two upper case hex letters of every byte value. */
+const char HEX_PAIRS_UPPER[] =
+	"000102030405060708090A0B0C0D0E0F"
+	"101112131415161718191A1B1C1D1E1F"
+	"202122232425262728292A2B2C2D2E2F"
+	"303132333435363738393A3B3C3D3E3F"
+	"404142434445464748494A4B4C4D4E4F"
+	"505152535455565758595A5B5C5D5E5F"
+	"606162636465666768696A6B6C6D6E6F"
+	"707172737475767778797A7B7C7D7E7F"
+	"808182838485868788898A8B8C8D8E8F"
+	"909192939495969798999A9B9C9D9E9F"
+	"A0A1A2A3A4A5A6A7A8A9AAABACADAEAF"
+	"B0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+	"C0C1C2C3C4C5C6C7C8C9CACBCCCDCECF"
+	"D0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+	"E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEF"
+	"F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+/** converts src to hex using the given pair table, using only dest_len bytes of dest before stopping. */
+static void to_hex_pairs(const char * pairs, char * dest, const unsigned char * src, const unsigned int dest_len) {
+	unsigned int dest_ix = 0;
+	for (unsigned int src_ix = 0; dest_ix + 1 < dest_len; src_ix++, dest_ix += 2) {
+		const char * pair = pairs + (*(src + src_ix) * 2);
+		*(dest + dest_ix + 0) = *(pair + 0);
+		*(dest + dest_ix + 1) = *(pair + 1);
+	}
+	// an odd dest_len gets the high letter of the last byte.
+	if (dest_ix < dest_len) {
+		*(dest + dest_ix) = *(pairs + (*(src + (dest_ix / 2)) * 2));
+	}
+}
+
+/** converts a byte array in src to an upper case hex array in dest, using only dest_len bytes of dest before stopping. */
 void to_hex(char * dest, const unsigned char * src, const unsigned int dest_len) {
-	for (unsigned int src_ix = 0, dest_ix = 0; dest_ix < dest_len; src_ix++, dest_ix += 2) {
-		unsigned char src_c = *(src + src_ix);
-		unsigned char nibble0 = (src_c >> 4) & 0xF;
-		unsigned char nibble1 = src_c & 0xF;
+	to_hex_pairs(HEX_PAIRS_UPPER, dest, src, dest_len);
+}
+
+/** converts a byte array in src to a lower case hex array in dest, using only dest_len bytes of dest before stopping. */
+void to_hex_lower(char * dest, const unsigned char * src, const unsigned int dest_len) {
+	to_hex_pairs(HEX_PAIRS_LOWER, dest, src, dest_len);
+}
+
+/** returns the number of hex letters in src_len bytes of src, without the leading zeros, and at least one. */
+unsigned int hex_significant_len(const unsigned char * src, const unsigned int src_len) {
+	unsigned int src_ix = 0;
+	while ((src_ix < src_len) && (*(src + src_ix) == 0)) {
+		src_ix++;
+	}
+	if (src_ix == src_len) {
+		return 1;
+	}
+	unsigned int hex_len = (src_len - src_ix) * 2;
+	if (*(src + src_ix) < 0x10) {
+		hex_len--;
+	}
+	return hex_len;
+}
+
+/** converts src_len bytes of src to hex, and passes the letters to sink in pieces of up to HEX_SINK_CHUNK_LEN. */
+unsigned int hex_stream(const unsigned char * src, const unsigned int src_len,
+                        const bool upper, const bool skip_leading_zeros,
+                        text_sink_t sink, void * context) {
+	const char * pairs = upper ? HEX_PAIRS_UPPER : HEX_PAIRS_LOWER;
+	unsigned int src_ix = 0;
 
-		*(dest + dest_ix + 0) = HEX_CAP[nibble0];
-		*(dest + dest_ix + 1) = HEX_CAP[nibble1];
+	// the first letter sent is the high letter of src[src_ix], unless skip_high is set.
+	bool skip_high = false;
+	if (skip_leading_zeros) {
+		while ((src_ix < src_len) && (*(src + src_ix) == 0)) {
+			src_ix++;
+		}
+		if (src_ix == src_len) {
+			sink(context, pairs, 1);
+			return 1;
+		}
+		skip_high = *(src + src_ix) < 0x10;
+	}
+
+	char chunk[HEX_SINK_CHUNK_LEN];
+	unsigned int chunk_len = 0;
+	unsigned int hex_len = 0;
+	for (; src_ix < src_len; src_ix++) {
+		const char * pair = pairs + (*(src + src_ix) * 2);
+		if (skip_high) {
+			skip_high = false;
+		} else {
+			chunk[chunk_len++] = *(pair + 0);
+		}
+		chunk[chunk_len++] = *(pair + 1);
+
+		// flush while there is still room for a full pair.
+		if (chunk_len + 2 > sizeof(chunk)) {
+			sink(context, chunk, chunk_len);
+			hex_len += chunk_len;
+			chunk_len = 0;
+		}
+	}
+	if (chunk_len > 0) {
+		sink(context, chunk, chunk_len);
+		hex_len += chunk_len;
 	}
+	return hex_len;
 }
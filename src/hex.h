@@ -5,6 +5,36 @@
 #ifndef HEX_H
 #define HEX_H
 
+#include <stdbool.h>
+
+/** number of letters hex_stream hands to the sink at a time. */
+#define HEX_SINK_CHUNK_LEN 32
+
+/** the two lower case hex letters of every byte value, the letters of byte b start at HEX_PAIRS_LOWER[b * 2]. */
+extern const char HEX_PAIRS_LOWER[];
+
+/** the two upper case hex letters of every byte value, the letters of byte b start at HEX_PAIRS_UPPER[b * 2]. */
+extern const char HEX_PAIRS_UPPER[];
+
+/** receives encoded letters a piece at a time, from hex_stream and encode_base_stream. */
+typedef void (*text_sink_t)(void * context, const char * text, const unsigned int text_len);
+
+/** converts a byte array in src to an upper case hex array in dest, using only dest_len bytes of dest before stopping. */
 void to_hex(char * dest, const unsigned char * src, const unsigned int dest_len);
 
+/** converts a byte array in src to a lower case hex array in dest, using only dest_len bytes of dest before stopping. */
+void to_hex_lower(char * dest, const unsigned char * src, const unsigned int dest_len);
+
+/** returns the number of hex letters in src_len bytes of src, without the leading zeros, and at least one. */
+unsigned int hex_significant_len(const unsigned char * src, const unsigned int src_len);
+
+/**
+ * converts src_len bytes of src to hex, and passes the letters to sink in pieces of up to HEX_SINK_CHUNK_LEN.
+ * if skip_leading_zeros is set, the leading zero letters are not sent, except for a single zero if the value is zero.
+ * returns the number of letters sent.
+ */
+unsigned int hex_stream(const unsigned char * src, const unsigned int src_len,
+                        const bool upper, const bool skip_leading_zeros,
+                        text_sink_t sink, void * context);
+
 #endif // HEX_H
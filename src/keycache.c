@@ -0,0 +1,63 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+#include "keycache.h"
+#include <string.h>
+
+/** the cached keys, in no order. */
+static key_cache_entry_t key_cache[KEY_CACHE_ENTRIES];
+
+/** lookups and additions since the cache was wiped, it stamps the entries as they are used. */
+static uint32_t key_cache_clock;
+
+static uint32_t key_cache_hit_count;
+
+static uint32_t key_cache_miss_count;
+
+/** returns the next use stamp. a session ends long before 2^32 uses, and a stamp that wrapped to 0 would only look empty. */
+static uint32_t key_cache_tick(void) {
+	return ++key_cache_clock;
+}
+
+const key_cache_entry_t * key_cache_find(const unsigned char * path) {
+	for(unsigned int ix = 0; ix < KEY_CACHE_ENTRIES; ix++) {
+		key_cache_entry_t * entry = key_cache + ix;
+		if((entry->used != 0) && (memcmp(entry->path, path, BIP44_BYTE_LENGTH) == 0)) {
+			key_cache_hit_count++;
+			entry->used = key_cache_tick();
+			return entry;
+		}
+	}
+	key_cache_miss_count++;
+	return NULL;
+}
+
+void key_cache_add(const unsigned char * path, const unsigned char * public_key, const char * address) {
+	// an empty entry, or else the least recently used one.
+	key_cache_entry_t * entry = key_cache;
+	for(unsigned int ix = 1; ix < KEY_CACHE_ENTRIES; ix++) {
+		if(key_cache[ix].used < entry->used) {
+			entry = key_cache + ix;
+		}
+	}
+	memmove(entry->path, path, BIP44_BYTE_LENGTH);
+	memmove(entry->public_key, public_key, PUBLIC_KEY_LEN);
+	memmove(entry->address, address, ADDRESS_LEN);
+	entry->used = key_cache_tick();
+}
+
+void key_cache_wipe(void) {
+	memset(key_cache, 0x00, sizeof(key_cache));
+	key_cache_clock = 0;
+	key_cache_hit_count = 0;
+	key_cache_miss_count = 0;
+}
+
+uint32_t key_cache_hits(void) {
+	return key_cache_hit_count;
+}
+
+uint32_t key_cache_misses(void) {
+	return key_cache_miss_count;
+}
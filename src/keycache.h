@@ -0,0 +1,41 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+#ifndef KEYCACHE_H
+#define KEYCACHE_H
+
+#include <stdint.h>
+#include "shared.h"
+
+/** number of paths whose public key and address are kept, the least recently used is replaced when it is full. */
+#define KEY_CACHE_ENTRIES 4
+
+/** a public key, and its address, for a bip44 path that was asked for before. */
+typedef struct {
+	/** the bip44 path, as the host sent it. */
+	unsigned char path[BIP44_BYTE_LENGTH];
+	/** the uncompressed public key. */
+	unsigned char public_key[PUBLIC_KEY_LEN];
+	/** the rendered DAG address, not NUL terminated. */
+	char address[ADDRESS_LEN];
+	/** when the entry was last used, in lookups since the cache was wiped, 0 if the entry is empty. */
+	uint32_t used;
+} key_cache_entry_t;
+
+/** returns the entry for the bip44 path, counting a hit and marking it recently used, or counts a miss and returns NULL. */
+const key_cache_entry_t * key_cache_find(const unsigned char * path);
+
+/** adds the public key and address derived for the bip44 path, in place of the least recently used entry if it is full. */
+void key_cache_add(const unsigned char * path, const unsigned char * public_key, const char * address);
+
+/** empties the cache, and clears the counters. */
+void key_cache_wipe(void);
+
+/** number of key_cache_find calls that found their path, since the cache was wiped. */
+uint32_t key_cache_hits(void);
+
+/** number of key_cache_find calls that did not find their path, since the cache was wiped. */
+uint32_t key_cache_misses(void);
+
+#endif // KEYCACHE_H
@@ -0,0 +1,172 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+#include "keyderive.h"
+#include <stdbool.h>
+#include <string.h>
+
+/** length of a compressed public key, its parity byte then x. */
+#define COMPRESSED_PUBLIC_KEY_LEN 33
+
+/** top bit of a hardened level's index. */
+#define HARDENED_INDEX 0x80000000
+
+/** order of the secp256k1 group, child private keys are added modulo it. */
+static const unsigned char SECP256K1_ORDER[PRIVATE_KEY_LEN] = {
+	0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFE,
+	0xBA,0xAE,0xDC,0xE6,0xAF,0x48,0xA0,0x3B,0xBF,0xD2,0x5E,0x8C,0xD0,0x36,0x41,0x41
+};
+
+/** a derived bip32 node. */
+typedef struct {
+	/** the path of the node, path_len is 0 when the node is empty. */
+	unsigned int path[BIP44_PATH_LEN];
+	unsigned int path_len;
+	unsigned char private_key[PRIVATE_KEY_LEN];
+	unsigned char chain_code[CHAIN_CODE_LEN];
+	/** the compressed public key, which the non-hardened children are derived from. */
+	unsigned char public_key[COMPRESSED_PUBLIC_KEY_LEN];
+} derived_node_t;
+
+/** the hardened account node, m/44'/1137'/account', as the seed derived it. */
+static derived_node_t account_node;
+
+/** the change node last derived from account_node, the address indexes of a request are usually all under it. */
+static derived_node_t change_node;
+
+static void compress_public_key(const unsigned char * private_key, unsigned char * compressed) {
+	cx_ecfp_private_key_t privateKey;
+	cx_ecfp_public_key_t publicKey;
+	cx_ecdsa_init_private_key(CX_CURVE_256K1, private_key, PRIVATE_KEY_LEN, &privateKey);
+	cx_ecdsa_init_public_key(CX_CURVE_256K1, NULL, 0, &publicKey);
+	cx_ecfp_generate_pair(CX_CURVE_256K1, &publicKey, &privateKey, 1);
+	cx_ecdsa_init_private_key(CX_CURVE_256K1, NULL, 0, &privateKey);
+
+	// W is 0x04, x, then y, the prefix of the compressed key is the parity of y.
+	compressed[0] = 0x02 | (publicKey.W[PUBLIC_KEY_LEN - 1] & 0x01);
+	memmove(compressed + 1, publicKey.W + 1, COMPRESSED_PUBLIC_KEY_LEN - 1);
+}
+
+/**
+ * derives the non-hardened child of parent at index, as bip32 CKDpriv does, computing its public key when asked.
+ * returns false, leaving child empty, for the one in 2^127 indexes bip32 has no key for.
+ */
+static bool derive_child(const derived_node_t * parent, const unsigned int index, derived_node_t * child, const bool with_public_key) {
+	unsigned char data[COMPRESSED_PUBLIC_KEY_LEN + 4];
+	memmove(data, parent->public_key, COMPRESSED_PUBLIC_KEY_LEN);
+	data[COMPRESSED_PUBLIC_KEY_LEN] = (index >> 24) & 0xFF;
+	data[COMPRESSED_PUBLIC_KEY_LEN + 1] = (index >> 16) & 0xFF;
+	data[COMPRESSED_PUBLIC_KEY_LEN + 2] = (index >> 8) & 0xFF;
+	data[COMPRESSED_PUBLIC_KEY_LEN + 3] = index & 0xFF;
+
+	// the left half tweaks the parent's private key, the right half is the child's chain code.
+	unsigned char hmac[CX_SHA512_SIZE];
+	cx_hmac_sha512(parent->chain_code, CHAIN_CODE_LEN, data, sizeof(data), hmac, sizeof(hmac));
+
+	bool valid = cx_math_cmp(hmac, (unsigned char *)SECP256K1_ORDER, PRIVATE_KEY_LEN) < 0;
+	if(valid) {
+		cx_math_addm(child->private_key, hmac, (unsigned char *)parent->private_key, (unsigned char *)SECP256K1_ORDER, PRIVATE_KEY_LEN);
+		valid = !cx_math_is_zero(child->private_key, PRIVATE_KEY_LEN);
+	}
+	if(!valid) {
+		memset(hmac, 0x00, sizeof(hmac));
+		memset(child, 0x00, sizeof(derived_node_t));
+		return false;
+	}
+
+	memmove(child->chain_code, hmac + PRIVATE_KEY_LEN, CHAIN_CODE_LEN);
+	memset(hmac, 0x00, sizeof(hmac));
+	memmove(child->path, parent->path, parent->path_len * sizeof(unsigned int));
+	child->path[parent->path_len] = index;
+	child->path_len = parent->path_len + 1;
+	if(with_public_key) {
+		compress_public_key(child->private_key, child->public_key);
+	}
+	return true;
+}
+
+/** true if the path is a hardened account, then at most the two non-hardened bip44 levels under it. */
+static bool is_under_account(const unsigned int * path, const unsigned int path_len) {
+	if((path_len < BIP44_ACCOUNT_PATH_LEN) || (path_len > BIP44_PATH_LEN)) {
+		return false;
+	}
+	for(unsigned int ix = 0; ix < path_len; ix++) {
+		const bool hardened = (path[ix] & HARDENED_INDEX) != 0;
+		if(hardened != (ix < BIP44_ACCOUNT_PATH_LEN)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/** returns true if node holds the first path_len levels of path. */
+static bool node_matches(const derived_node_t * node, const unsigned int * path, const unsigned int path_len) {
+	return (node->path_len == path_len) && (memcmp(node->path, path, path_len * sizeof(unsigned int)) == 0);
+}
+
+/** returns the account node of the path, deriving it from the seed if it is not the kept one. */
+static const derived_node_t * account_node_of(const unsigned int * path) {
+	if(!node_matches(&account_node, path, BIP44_ACCOUNT_PATH_LEN)) {
+		derive_node_wipe();
+		os_perso_derive_node_bip32(CX_CURVE_256K1, (unsigned int *)path, BIP44_ACCOUNT_PATH_LEN, account_node.private_key, account_node.chain_code);
+		compress_public_key(account_node.private_key, account_node.public_key);
+		memmove(account_node.path, path, BIP44_ACCOUNT_PATH_LEN * sizeof(unsigned int));
+		account_node.path_len = BIP44_ACCOUNT_PATH_LEN;
+	}
+	return &account_node;
+}
+
+void derive_node(const unsigned int * path, unsigned int path_len, unsigned char * private_key, unsigned char * chain_code) {
+	if(!is_under_account(path, path_len)) {
+		os_perso_derive_node_bip32(CX_CURVE_256K1, (unsigned int *)path, path_len, private_key, chain_code);
+		return;
+	}
+
+	const derived_node_t * node = account_node_of(path);
+	derived_node_t index_node;
+	bool valid = true;
+	if(path_len > BIP44_ACCOUNT_PATH_LEN) {
+		if(!node_matches(&change_node, path, BIP44_ACCOUNT_PATH_LEN + 1)) {
+			valid = derive_child(node, path[BIP44_ACCOUNT_PATH_LEN], &change_node, true);
+		}
+		node = &change_node;
+	}
+	// the address index is a leaf, nothing is derived from it, so its public key is not needed here.
+	if(valid && (path_len > BIP44_ACCOUNT_PATH_LEN + 1)) {
+		valid = derive_child(node, path[BIP44_ACCOUNT_PATH_LEN + 1], &index_node, false);
+		node = &index_node;
+	}
+
+	if(!valid) {
+		// what to use in place of a missing key is up to the seed's derivation.
+		os_perso_derive_node_bip32(CX_CURVE_256K1, (unsigned int *)path, path_len, private_key, chain_code);
+	} else {
+		memmove(private_key, node->private_key, PRIVATE_KEY_LEN);
+		if(chain_code != NULL) {
+			memmove(chain_code, node->chain_code, CHAIN_CODE_LEN);
+		}
+	}
+	memset(&index_node, 0x00, sizeof(index_node));
+}
+
+void derive_public_key(const unsigned int * bip44_path, cx_ecfp_public_key_t * public_key) {
+	cx_ecfp_private_key_t privateKey;
+	unsigned char privateKeyData[PRIVATE_KEY_LEN];
+
+	derive_node(bip44_path, BIP44_PATH_LEN, privateKeyData, NULL);
+	cx_ecdsa_init_private_key(CX_CURVE_256K1, privateKeyData, PRIVATE_KEY_LEN, &privateKey);
+
+	// generate the public key.
+	cx_ecdsa_init_public_key(CX_CURVE_256K1, NULL, 0, public_key);
+	cx_ecfp_generate_pair(CX_CURVE_256K1, public_key, &privateKey, 1);
+
+	// clear private key data
+	cx_ecdsa_init_private_key(CX_CURVE_256K1, NULL, 0, &privateKey);
+	memset(privateKeyData, 0x00, sizeof(privateKeyData));
+}
+
+void derive_node_wipe(void) {
+	memset(&account_node, 0x00, sizeof(account_node));
+	memset(&change_node, 0x00, sizeof(change_node));
+}
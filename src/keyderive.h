@@ -0,0 +1,29 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+#ifndef KEYDERIVE_H
+#define KEYDERIVE_H
+
+#include "os.h"
+#include "cx.h"
+#include "shared.h"
+
+/** length of a secp256k1 private key. */
+#define PRIVATE_KEY_LEN 32
+
+/**
+ * derives the private key, and chain code, of a bip32 path, as os_perso_derive_node_bip32 does.
+ * the hardened account node, m/44'/1137'/account', comes from the seed once per session, the non-hardened
+ * change and address index levels under it are derived from the kept node. other paths go to the seed.
+ * chain_code may be NULL.
+ */
+void derive_node(const unsigned int * path, unsigned int path_len, unsigned char * private_key, unsigned char * chain_code);
+
+/** derives the public key of the bip44 path into public_key, clearing the private key after. */
+void derive_public_key(const unsigned int * bip44_path, cx_ecfp_public_key_t * public_key);
+
+/** forgets the kept nodes, so the next derivation goes to the seed again. */
+void derive_node_wipe(void);
+
+#endif // KEYDERIVE_H
@@ -0,0 +1,149 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+#include "keystore.h"
+#include "os.h"
+#include "cx.h"
+#include "keyderive.h"
+#include <stddef.h>
+#include <string.h>
+
+/** layout of the store, a store written by another layout is emptied. */
+#define KEY_STORE_VERSION 1
+
+/** the store, in the app's flash, written with nvm_write. */
+const key_store_t N_storage_real;
+#define N_storage (*(volatile key_store_t *)PIC(&N_storage_real))
+
+/** the seed fingerprint is of the coin node, m/44'/1137', the one path all of the app's keys are under. */
+static const unsigned int SEED_FINGERPRINT_PATH[] = { BIP44_PURPOSE, BIP44_COIN_TYPE };
+
+/** true once this session has checked the store. */
+static bool key_store_checked;
+
+/** true once this session has added an entry, a session adds at most one, to spare the flash. */
+static bool key_store_written;
+
+/** the fingerprint of the seed, as of when the store was checked. */
+static unsigned char seed_fingerprint[SEED_FINGERPRINT_LEN];
+
+/** the store, read through its PIC address. */
+static const key_store_t * key_store(void) {
+	return (const key_store_t *)&N_storage;
+}
+
+/** computes the start of the sha256 of the store's contents, everything before its checksum. */
+static void key_store_checksum(unsigned char * checksum) {
+	unsigned char hash[CX_SHA256_SIZE];
+	cx_hash_sha256((const unsigned char *)key_store(), offsetof(key_store_t, checksum), hash, sizeof(hash));
+	memmove(checksum, hash, KEY_STORE_CHECKSUM_LEN);
+}
+
+/** writes the checksum of the store's current contents, which makes them valid. */
+static void key_store_seal(void) {
+	unsigned char checksum[KEY_STORE_CHECKSUM_LEN];
+	key_store_checksum(checksum);
+	nvm_write((void *)key_store()->checksum, checksum, KEY_STORE_CHECKSUM_LEN);
+}
+
+/**
+ * fingerprints the seed with the start of the sha256 of the coin node's chain code.
+ * the hardened levels take no point multiplication, so this costs far less than deriving a public key.
+ */
+static void compute_seed_fingerprint(void) {
+	unsigned char private_key[PRIVATE_KEY_LEN];
+	unsigned char chain_code[CHAIN_CODE_LEN];
+	derive_node(SEED_FINGERPRINT_PATH, sizeof(SEED_FINGERPRINT_PATH) / sizeof(SEED_FINGERPRINT_PATH[0]), private_key, chain_code);
+	memset(private_key, 0x00, sizeof(private_key));
+
+	unsigned char hash[CX_SHA256_SIZE];
+	cx_hash_sha256(chain_code, CHAIN_CODE_LEN, hash, sizeof(hash));
+	memset(chain_code, 0x00, sizeof(chain_code));
+	memmove(seed_fingerprint, hash, SEED_FINGERPRINT_LEN);
+}
+
+/** empties the store, under this session's seed, a field at a time rather than from a copy of it on the stack. */
+static void key_store_reset(void) {
+	const key_store_t * store = key_store();
+	const uint8_t unused = 0;
+	for(unsigned int ix = 0; ix < KEY_STORE_ENTRIES; ix++) {
+		nvm_write((void *)&store->entries[ix].used, (void *)&unused, sizeof(unused));
+	}
+	const uint8_t next = 0;
+	nvm_write((void *)&store->next, (void *)&next, sizeof(next));
+	nvm_write((void *)store->seed_fingerprint, seed_fingerprint, SEED_FINGERPRINT_LEN);
+	const uint8_t version = KEY_STORE_VERSION;
+	nvm_write((void *)&store->version, (void *)&version, sizeof(version));
+	key_store_seal();
+}
+
+/** checks the store once per session, so no key from a damaged store or another seed is ever returned. */
+static void key_store_check(void) {
+	if(key_store_checked) {
+		return;
+	}
+	compute_seed_fingerprint();
+
+	const key_store_t * store = key_store();
+	unsigned char checksum[KEY_STORE_CHECKSUM_LEN];
+	key_store_checksum(checksum);
+	if((store->version != KEY_STORE_VERSION) || (store->next >= KEY_STORE_ENTRIES)
+	   || (memcmp(store->checksum, checksum, KEY_STORE_CHECKSUM_LEN) != 0)
+	   || (memcmp(store->seed_fingerprint, seed_fingerprint, SEED_FINGERPRINT_LEN) != 0)) {
+		key_store_reset();
+	}
+	key_store_checked = true;
+}
+
+/** returns the entry stored for the bip44 path, or NULL. */
+static const key_store_entry_t * key_store_entry(const unsigned char * path) {
+	const key_store_t * store = key_store();
+	for(unsigned int ix = 0; ix < KEY_STORE_ENTRIES; ix++) {
+		const key_store_entry_t * entry = store->entries + ix;
+		if((entry->used != 0) && (memcmp(entry->path, path, BIP44_BYTE_LENGTH) == 0)) {
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+bool key_store_find(const unsigned char * path, unsigned char * public_key, char * address) {
+	key_store_check();
+
+	const key_store_entry_t * entry = key_store_entry(path);
+	if(entry == NULL) {
+		return false;
+	}
+	memmove(public_key, entry->public_key, PUBLIC_KEY_LEN);
+	memmove(address, entry->address, ADDRESS_LEN);
+	return true;
+}
+
+void key_store_add(const unsigned char * path, const unsigned char * public_key, const char * address) {
+	// each add costs three flash writes, so a session makes one at most, and never for a path already stored.
+	if(key_store_written) {
+		return;
+	}
+	key_store_check();
+	if(key_store_entry(path) != NULL) {
+		return;
+	}
+	key_store_written = true;
+
+	// entries are replaced in turn rather than by use, so a lookup never writes to flash.
+	const key_store_t * store = key_store();
+	const uint8_t slot = store->next;
+	key_store_entry_t entry;
+	memmove(entry.path, path, BIP44_BYTE_LENGTH);
+	memmove(entry.public_key, public_key, PUBLIC_KEY_LEN);
+	memmove(entry.address, address, ADDRESS_LEN);
+	entry.used = 1;
+	nvm_write((void *)(store->entries + slot), &entry, sizeof(entry));
+
+	const uint8_t next = (slot + 1) % KEY_STORE_ENTRIES;
+	nvm_write((void *)&store->next, (void *)&next, sizeof(next));
+
+	// until the new checksum is written the store does not check, so a write cut short only empties it.
+	key_store_seal();
+}
@@ -0,0 +1,58 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+#ifndef KEYSTORE_H
+#define KEYSTORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "shared.h"
+
+/** number of paths whose public key and address are kept in flash, across restarts of the app. */
+#define KEY_STORE_ENTRIES 4
+
+/** length of the seed fingerprint the store was written under. */
+#define SEED_FINGERPRINT_LEN 8
+
+/** length of the checksum of the store. */
+#define KEY_STORE_CHECKSUM_LEN 8
+
+/** a public key, and its address, for a bip44 path asked for in an earlier session. */
+typedef struct {
+	/** the bip44 path, as the host sent it. */
+	unsigned char path[BIP44_BYTE_LENGTH];
+	/** the uncompressed public key. */
+	unsigned char public_key[PUBLIC_KEY_LEN];
+	/** the rendered DAG address, not NUL terminated. */
+	char address[ADDRESS_LEN];
+	/** 1 once the entry has been written. */
+	uint8_t used;
+} key_store_entry_t;
+
+/** the store, as it is laid out in flash. */
+typedef struct {
+	/** KEY_STORE_VERSION once the store has been written, the flash starts out zeroed. */
+	uint8_t version;
+	/** the entry the next new path replaces, entries are replaced in turn. */
+	uint8_t next;
+	/** fingerprint of the seed the keys were derived from. */
+	unsigned char seed_fingerprint[SEED_FINGERPRINT_LEN];
+	key_store_entry_t entries[KEY_STORE_ENTRIES];
+	/** the start of the sha256 of everything above it. */
+	unsigned char checksum[KEY_STORE_CHECKSUM_LEN];
+} key_store_t;
+
+/**
+ * copies out the public key and address stored for the bip44 path, returning false if it is not stored.
+ * the first call of a session checks the store, and empties it if it is damaged or was written under another seed.
+ */
+bool key_store_find(const unsigned char * path, unsigned char * public_key, char * address);
+
+/**
+ * stores the public key and address derived for the bip44 path, in place of the oldest entry if it is full.
+ * does nothing if the path is already stored, or if this session has already stored a path.
+ */
+void key_store_add(const unsigned char * path, const unsigned char * public_key, const char * address);
+
+#endif // KEYSTORE_H
@@ -0,0 +1,126 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+#include "kryo.h"
+#include "base-encoding.h"
+#include <string.h>
+
+/** longest base10 field, the ordinal and fee are 64-bit. */
+#define KRYO_BASE10_MAX_LEN 8
+
+/** scratch limbs for a base10 field. */
+#define KRYO_BASE10_SCRATCH_LIMBS BASEX_CHUNKS_SCRATCH_LIMBS(KRYO_BASE10_MAX_LEN)
+
+/** prefix of the v1 kryo serialization, ahead of the text length, the class id of a string. */
+static const unsigned char KRYO_TX_V1_PREFIX[] = {0x03};
+
+static const kryo_field_t KRYO_TX_V1_FIELDS[] = {
+	{ TX_FIELD_PARENT_COUNT, KRYO_COUNT, MAX_TX_PARENTS },
+	{ TX_FIELD_PARENT, KRYO_TEXT, 0xFF },
+	{ TX_FIELD_AMOUNT, KRYO_BASE16, 0xFF },
+	{ TX_FIELD_LAST_TX_REF_HASH, KRYO_TEXT, 0xFF },
+	{ TX_FIELD_LAST_TX_REF_ORDINAL, KRYO_BASE10, KRYO_BASE10_MAX_LEN },
+	{ TX_FIELD_FEE, KRYO_BASE10, KRYO_BASE10_MAX_LEN },
+	{ TX_FIELD_SALT, KRYO_BASE16, 0xFF },
+};
+
+const kryo_schema_t KRYO_TX_V1_SCHEMA = {
+	KRYO_TX_V1_FIELDS, sizeof(KRYO_TX_V1_FIELDS) / sizeof(KRYO_TX_V1_FIELDS[0]),
+	KRYO_TX_V1_PREFIX, sizeof(KRYO_TX_V1_PREFIX)
+};
+
+/** sends a byte count as decimal text, and returns the number of digits. */
+static unsigned int add_number(const unsigned char number, text_sink_t sink, void * context) {
+	char digits[3];
+	unsigned int digits_len = 0;
+	if(number >= 100) {
+		digits[digits_len++] = '0' + (number / 100);
+	}
+	if(number >= 10) {
+		digits[digits_len++] = '0' + ((number / 10) % 10);
+	}
+	digits[digits_len++] = '0' + (number % 10);
+	if(sink != NULL) {
+		sink(context, digits, digits_len);
+	}
+	return digits_len;
+}
+
+unsigned int kryo_serialize(const unsigned char * tx,
+                            const tx_field_view_t * views, const unsigned int views_len,
+                            text_sink_t sink, void * context) {
+	unsigned int text_len = 0;
+	for(unsigned int ix = 0; ix < views_len; ix++) {
+		const tx_field_view_t * view = views + ix;
+		const unsigned char * data = tx + view->offset;
+
+		// the length of the field's text, which comes first, and then the text.
+		switch(view->encoding) {
+		case KRYO_COUNT:
+			text_len += add_number(view->len, sink, context);
+			break;
+		case KRYO_TEXT:
+			text_len += add_number(view->len, sink, context) + view->len;
+			if(sink != NULL) {
+				sink(context, (const char *)data, view->len);
+			}
+			break;
+		case KRYO_BASE10: {
+			uint32_t scratch[KRYO_BASE10_SCRATCH_LIMBS];
+			unsigned int base10_len = encode_base_chunks(10, data, view->len, scratch, KRYO_BASE10_SCRATCH_LIMBS);
+			text_len += add_number(base10_len, sink, context) + base10_len;
+			if(sink != NULL) {
+				encode_base_stream(10, scratch, KRYO_BASE10_SCRATCH_LIMBS, base10_len, sink, context);
+			}
+		}
+		break;
+		default: {
+			unsigned int base16_len = hex_significant_len(data, view->len);
+			text_len += add_number(base16_len, sink, context) + base16_len;
+			if(sink != NULL) {
+				hex_stream(data, view->len, false, true, sink, context);
+			}
+		}
+		break;
+		}
+	}
+	return text_len;
+}
+
+/** writes value as a kryo variable length int into buffer, and returns the number of bytes written, at most 5. */
+static unsigned int utf8Length(unsigned char * buffer, unsigned int value) {
+	unsigned int utfLengthAsHex = 0;
+	if (value >> 6 == 0) {
+		utfLengthAsHex = 1;
+		buffer[0] = (value | 0x80);         // Set bit 8.
+	} else if (value >> 13 == 0) {
+		utfLengthAsHex = 2;
+		buffer[0] = (value | 0x40 | 0x80);         // Set bit 7 and 8.
+		buffer[1] = (value >> 6);
+	} else if (value >> 20 == 0) {
+		utfLengthAsHex = 3;
+		buffer[0] = (value | 0x40 | 0x80);         // Set bit 7 and 8.
+		buffer[1] = ((value >> 6) | 0x80);         // Set bit 8.
+		buffer[2] = (value >> 13);
+	} else if (value >> 27 == 0) {
+		utfLengthAsHex = 4;
+		buffer[0] = (value | 0x40 | 0x80);         // Set bit 7 and 8.
+		buffer[1] = ((value >> 6) | 0x80);         // Set bit 8.
+		buffer[2] = ((value >> 13) | 0x80);         // Set bit 8.
+		buffer[3] = (value >> 20);
+	} else {
+		utfLengthAsHex = 5;
+		buffer[0] = (value | 0x40 | 0x80);         // Set bit 7 and 8.
+		buffer[1] = ((value >> 6) | 0x80);         // Set bit 8.
+		buffer[2] = ((value >> 13) | 0x80);         // Set bit 8.
+		buffer[3] = ((value >> 20) | 0x80);         // Set bit 8.
+		buffer[4] = (value >> 27);
+	}
+	return utfLengthAsHex;
+}
+
+unsigned int kryo_header(const kryo_schema_t * schema, unsigned char * buffer, const unsigned int text_len) {
+	memmove(buffer, schema->prefix, schema->prefix_len);
+	return schema->prefix_len + utf8Length(buffer + schema->prefix_len, text_len + 1);
+}
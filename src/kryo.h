@@ -0,0 +1,76 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+#ifndef KRYO_H
+#define KRYO_H
+
+#include "hex.h"
+#include "shared.h"
+
+/** most parents a transaction can have, each takes a screen, and the amount and fee take two more. */
+#define MAX_TX_PARENTS (MAX_TX_TEXT_SCREENS - 2)
+
+/** longest kryo prefix, the class id and the references flag. */
+#define KRYO_PREFIX_MAX_LEN 2
+
+/** longest kryo header, the prefix and a five byte length. */
+#define KRYO_HEADER_MAX_LEN (KRYO_PREFIX_MAX_LEN + 5)
+
+/** how a field's data is written into the kryo text. */
+enum KRYO_ENCODING {
+	/** no data, the length byte is a count of the next schema field, written in decimal. */
+	KRYO_COUNT,
+	/** the data as is, after its length in decimal. */
+	KRYO_TEXT,
+	/** a big-endian number as significant decimal digits, after the number of digits. */
+	KRYO_BASE10,
+	/** a big-endian number as significant lower case hex letters, after the number of letters. */
+	KRYO_BASE16
+};
+
+/** one field of a transaction schema. */
+typedef struct {
+	/** the field, from enum TX_FIELD. */
+	unsigned char field;
+	/** how the field is written, from enum KRYO_ENCODING. */
+	unsigned char encoding;
+	/** longest the field's data can be, or for a count, the largest count. */
+	unsigned char max_len;
+} kryo_field_t;
+
+/** a transaction layout, the fields in the order they appear in raw_tx, and the kryo prefix its hash starts with. */
+typedef struct {
+	const kryo_field_t * fields;
+	unsigned int fields_len;
+	const unsigned char * prefix;
+	unsigned int prefix_len;
+} kryo_schema_t;
+
+/**
+ * a view of one decoded field of the transaction in raw_tx.
+ * offset is where the field's data starts, just past its length byte.
+ * a count has no data, its len is the count.
+ */
+typedef struct {
+	unsigned char field;
+	unsigned char encoding;
+	unsigned char len;
+	unsigned short offset;
+} tx_field_view_t;
+
+/** the v1 transaction: parents, amount, last tx ref hash and ordinal, fee and salt. */
+extern const kryo_schema_t KRYO_TX_V1_SCHEMA;
+
+/**
+ * sends the kryo text of views_len decoded fields of tx to sink. a NULL sink only measures it.
+ * returns the text length.
+ */
+unsigned int kryo_serialize(const unsigned char * tx,
+                            const tx_field_view_t * views, const unsigned int views_len,
+                            text_sink_t sink, void * context);
+
+/** writes the schema's kryo prefix and the length ahead of text_len letters of text into buffer, and returns the header length. */
+unsigned int kryo_header(const kryo_schema_t * schema, unsigned char * buffer, const unsigned int text_len);
+
+#endif // KRYO_H
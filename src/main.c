@@ -26,6 +26,10 @@
 #include "shared.h"
 #include "selector.h"
 #include "format.h"
+#include "signdata.h"
+#include "keycache.h"
+#include "keyderive.h"
+#include "keystore.h"
 
 /** message security prefix length */
 #define MESSAGE_PREFIX_LENGTH 31
@@ -42,6 +46,9 @@ static const uint8_t message_prefix_delimeter[MESSAGE_PREFIX_DELIMETER_LENGTH] =
 /** Byte length of message size param */
 #define MESSAGE_SIZE_LEN 4
 
+/** most ascii digits of a message size */
+#define MESSAGE_LENGTH_MAX_DIGITS 10
+
 #define DEBUG_OUT_ENABLED false
 
 #define MAX_EXIT_TIMER 4098
@@ -98,8 +105,34 @@ unsigned char G_io_seproxyhal_spi_buffer[IO_SEPROXYHAL_BUFFER_SIZE_B];
 /** instruction to blind sign a message and send back the signature. */
 #define INS_BLIND_SIGN 0x06
 
+/** instruction to sign structured (json) data, showing some of its values, and send back the signature. */
+#define INS_SIGN_DATA 0x08
+
+/** instruction to send back the hit and miss counts of the public key cache. */
+#define INS_GET_KEY_CACHE_STATS 0x0A
+
+/** instruction to send back the public keys, or addresses, of consecutive address indexes. */
+#define INS_GET_PUBLIC_KEYS 0x0C
+
+/** instruction to send back the public key and chain code of an account, once the user approves. */
+#define INS_GET_ACCOUNT_KEY 0x0E
+
 /** #### instructions end #### */
 
+/** P2 of the first part of the transaction being signed, the other parts must have the same. */
+static unsigned char sign_p2;
+
+/** running sha512 of the blind signed message, or the structured data, being signed, from its header on. */
+static cx_sha512_t msg_hash_context;
+
+/** bytes of the blind signed message not hashed yet, the bip44 path follows them. */
+static unsigned int msg_left;
+
+/** text sink that adds the letters to the sha512 context. */
+static void sha512_text_sink(void * context, const char * text, const unsigned int text_len) {
+	cx_hash((cx_hash_t *)context, 0, (const unsigned char *)text, text_len, NULL, 0);
+}
+
 /** some kind of event loop */
 unsigned short io_exchange_al(unsigned char channel, unsigned short tx_len) {
 	switch (channel & ~(IO_FLAGS)) {
@@ -122,7 +155,7 @@ unsigned short io_exchange_al(unsigned char channel, unsigned short tx_len) {
 		}
 
 	default:
-		hashTainted = 1;
+		operation = OP_NONE;
 		THROW(INVALID_PARAMETER);
 	}
 	return 0;
@@ -145,25 +178,42 @@ static int get_msg_length(void) {
 				+ (message_length_bytes[3]));
 }
 
-static void init_msg_sign_buf(int message_length) {
-	raw_tx_ix = 0;
+/** starts the hash of a blind signed message with the message prefix, the message length in ascii, and a delimeter. */
+static void init_msg_hash(const unsigned int message_length) {
+	cx_sha512_init(&msg_hash_context);
+	cx_hash((cx_hash_t *)&msg_hash_context, 0, message_prefix, MESSAGE_PREFIX_LENGTH, NULL, 0);
 
-	unsigned char * out = raw_tx + raw_tx_ix;
-	memcpy(out, message_prefix, MESSAGE_PREFIX_LENGTH);
-	raw_tx_ix += MESSAGE_PREFIX_LENGTH;
+	// the message length, in ascii.
+	char message_length_ascii_bytes[MESSAGE_LENGTH_MAX_DIGITS + 1];
+	const unsigned int message_digits_length = format_fixed_point(message_length, 0, false, false, message_length_ascii_bytes, sizeof(message_length_ascii_bytes));
+	cx_hash((cx_hash_t *)&msg_hash_context, 0, (const unsigned char *)message_length_ascii_bytes, message_digits_length, NULL, 0);
 
-	int message_digits_length = getIntLength(message_length);
-	// Convert message length int to ascii values
-	char message_length_ascii_bytes[message_digits_length];
-	intToBytes(message_length_ascii_bytes, message_length);
+	cx_hash((cx_hash_t *)&msg_hash_context, 0, message_prefix_delimeter, MESSAGE_PREFIX_DELIMETER_LENGTH, NULL, 0);
+	msg_left = message_length;
+}
 
-	out = raw_tx + raw_tx_ix;
-	memcpy(out, message_length_ascii_bytes, message_digits_length);
-	raw_tx_ix += message_digits_length; 
+/** drops a pending account key export, so a signing instruction is never answered with the key. */
+static void drop_account_key_export(void) {
+	if (operation == OP_EXPORT_ACCOUNT_KEY) {
+		operation = OP_NONE;
+		ui_idle();
+	}
+}
 
-	out = raw_tx + raw_tx_ix;
-	memcpy(out, message_prefix_delimeter, MESSAGE_PREFIX_DELIMETER_LENGTH);
-	raw_tx_ix += MESSAGE_PREFIX_DELIMETER_LENGTH;
+/** starts op with its first part, nothing of the operation before it is carried over. */
+static void operation_begin(const enum OPERATION op) {
+	operation = op;
+	raw_tx_ix = 0;
+	raw_tx_len = 0;
+	msg_left = 0;
+}
+
+/** fails with sw, and drops the operation in flight, if there is one and it is not op, so a part only ever continues its own operation. */
+static void operation_continue(const enum OPERATION op, const unsigned short sw) {
+	if ((operation != OP_NONE) && (operation != op)) {
+		operation = OP_NONE;
+		THROW(sw);
+	}
 }
 
 /** main loop. */
@@ -194,13 +244,13 @@ static void constellation_main(void) {
 				// no apdu received, well, reset the session, and reset the
 				// bootloader configuration
 				if (rx == 0) {
-					hashTainted = 1;
+					operation = OP_NONE;
 					THROW(0x6982);
 				}
 
 				// if the buffer doesn't start with the magic byte, return an error.
 				if (G_io_apdu_buffer[0] != CLA) {
-					hashTainted = 1;
+					operation = OP_NONE;
 					THROW(0x6E00);
 				}
 
@@ -210,47 +260,97 @@ static void constellation_main(void) {
 				// we're getting a transaction to sign, in parts.
 				case INS_SIGN: {
 					Timer_Restart();
+					drop_account_key_export();
 					// check the third byte (0x02) for the instruction subtype.
 					if ((G_io_apdu_buffer[2] != P1_MORE) && (G_io_apdu_buffer[2] != P1_LAST)) {
-						hashTainted = 1;
+						operation = OP_NONE;
 						THROW(0x6A86);
 					}
 
-					// if this is the first transaction part, reset the hash and all the other temporary variables.
-					if (hashTainted) {
-						hashTainted = 0;
-						raw_tx_ix = 0;
-						raw_tx_len = 0;
+					// the fourth byte flags whether the transaction is streamed, and whether it is a token transfer, it must not change between parts.
+					if ((G_io_apdu_buffer[3] & ~(P2_STREAMED | P2_TOKEN)) != 0) {
+						operation = OP_NONE;
+						THROW(0x6B00);
+					}
+					// a part after the first must be of the transaction in flight, with its flags.
+					operation_continue(OP_SIGN_TX, 0x6B00);
+					if ((operation == OP_SIGN_TX) && (G_io_apdu_buffer[3] != sign_p2)) {
+						operation = OP_NONE;
+						THROW(0x6B00);
 					}
 
-					// move the contents of the buffer into raw_tx, and update raw_tx_ix to the end of the buffer, to be ready for the next part of the tx.
 					unsigned int len = get_apdu_buffer_length();
 					unsigned char * in = G_io_apdu_buffer + APDU_HEADER_LENGTH;
-					unsigned char * out = raw_tx + raw_tx_ix;
-					if (raw_tx_ix + len > MAX_TX_RAW_LENGTH) {
-						hashTainted = 1;
-						THROW(0x6D08);
+
+					// if this is the first transaction part, reset the hash and all the other temporary variables.
+					if (operation == OP_NONE) {
+						operation_begin(OP_SIGN_TX);
+						sign_p2 = G_io_apdu_buffer[3];
+						const kryo_schema_t * schema = &KRYO_TX_V1_SCHEMA;
+						if (sign_p2 & P2_STREAMED) {
+							// the first part of a streamed transaction starts with the length of its kryo text.
+							if (len < MESSAGE_SIZE_LEN) {
+								operation = OP_NONE;
+								THROW(0x6D08);
+							}
+							tx_stream_begin(schema, get_msg_length());
+							in += MESSAGE_SIZE_LEN;
+							len -= MESSAGE_SIZE_LEN;
+						} else {
+							tx_parse_begin(schema);
+						}
+						if (sign_p2 & P2_TOKEN) {
+							// the amount is shown in the ticker and decimals the registry has for the metagraph, unknown metagraphs are refused.
+							if (len < TOKEN_ID_LEN) {
+								operation = OP_NONE;
+								THROW(0x6D08);
+							}
+							const token_info_t * token = token_find(in, TOKEN_ID_LEN);
+							if (token == NULL) {
+								operation = OP_NONE;
+								THROW(0x6D45);
+							}
+							select_display_token(token);
+							in += TOKEN_ID_LEN;
+							len -= TOKEN_ID_LEN;
+						}
+					}
+
+					if (tx_streamed) {
+						// hash and select the fields straight out of the buffer, only a field split across parts is held back.
+						tx_stream_chunk(in, len);
+					} else {
+						// move the contents of the buffer into raw_tx, and update raw_tx_ix to the end of the buffer, to be ready for the next part of the tx.
+						unsigned char * out = raw_tx + raw_tx_ix;
+						if (raw_tx_ix + len > MAX_TX_RAW_LENGTH) {
+							operation = OP_NONE;
+							THROW(0x6D08);
+						}
+						memmove(out, in, len);
+						raw_tx_ix += len;
+
+						// parse the fields that are all there, so the last part only has a few fields left.
+						if (G_io_apdu_buffer[2] == P1_MORE) {
+							tx_parse_chunk(raw_tx_ix);
+						}
 					}
-					memmove(out, in, len);
-					raw_tx_ix += len;
 
 					// if this is the last part of the transaction, parse the transaction into human readable text, and display it.
 					if (G_io_apdu_buffer[2] == P1_LAST) {
 						raw_tx_len = raw_tx_ix;
 						raw_tx_ix = 0;
-						hash_data_ix = 0;
 						curr_scr_ix = 0;
-						memset(tx_desc, 0x00, sizeof(tx_desc));
 
-						// select the transaction fields.
-						select_display_fields();
-
-						// Format the selected fields.
-						format_display_values();
-						
-						// parse the transaction into machine readable hash.
-						calc_hash();
+						if (tx_streamed) {
+							// check the fields are all there, and finish the hash.
+							tx_stream_end();
+						} else {
+							// parse, select and format the rest of the transaction fields.
+							tx_parse_end();
 
+							// hash the transaction's machine readable serialization.
+							calc_hash();
+						}
 						// display the UI, starting at the top screen which is "Sign Tx Now".
 						ui_top_sign();
 					}
@@ -270,38 +370,45 @@ static void constellation_main(void) {
 					Timer_Restart();
 
 					cx_ecfp_public_key_t publicKey;
-					cx_ecfp_private_key_t privateKey;
 
 					if (rx < APDU_HEADER_LENGTH + BIP44_BYTE_LENGTH) {
-						hashTainted = 1;
+						operation = OP_NONE;
 						THROW(0x6D09);
 					}
 
 					/** BIP44 path, used to derive the private key from the mnemonic by calling os_perso_derive_node_bip32. */
 					unsigned char * bip44_in = G_io_apdu_buffer + APDU_HEADER_LENGTH;
-					unsigned int bip44_path[BIP44_PATH_LEN];
-					
-					uint32_t i;
-					for (i = 0; i < BIP44_PATH_LEN; i++) {
-						bip44_path[i] = (bip44_in[0] << 24) | (bip44_in[1] << 16) | (bip44_in[2] << 8) | (bip44_in[3]);
-						bip44_in += 4;
-					}
-					unsigned char privateKeyData[32];
-
-					os_perso_derive_node_bip32(CX_CURVE_256K1, bip44_path, BIP44_PATH_LEN, privateKeyData, NULL);
-					cx_ecdsa_init_private_key(CX_CURVE_256K1, privateKeyData, 32, &privateKey);
-
-					// generate the public key.
-					cx_ecdsa_init_public_key(CX_CURVE_256K1, NULL, 0, &publicKey);
-					cx_ecfp_generate_pair(CX_CURVE_256K1, &publicKey, &privateKey, 1);
 
-
-					// clear private key data
-					cx_ecdsa_init_private_key(CX_CURVE_256K1, NULL, 0, &privateKey);
-					// memset(&privateKey, 0x00, sizeof(privateKey));
-					memset(privateKeyData, 0x00, sizeof(privateKeyData));
-
-					display_public_key(publicKey.W);
+					// a path asked for again is answered from the cache, without deriving or encoding anything.
+					const key_cache_entry_t * cached = key_cache_find(bip44_in);
+					if (cached != NULL) {
+						// asked for twice, the path is one the wallet comes back to, so it is worth a flash write to keep.
+						key_store_add(cached->path, cached->public_key, cached->address);
+						display_address(cached->address);
+						refresh_public_key_display();
+						memmove(G_io_apdu_buffer, cached->public_key, PUBLIC_KEY_LEN);
+						tx = PUBLIC_KEY_LEN;
+						THROW(0x9000);
+					}
+					unsigned char bip44_bytes[BIP44_BYTE_LENGTH];
+					memmove(bip44_bytes, bip44_in, BIP44_BYTE_LENGTH);
+
+					// then one from an earlier session, kept in flash, so a restart does not mean deriving it again.
+					char address[ADDRESS_LEN];
+					if (!key_store_find(bip44_bytes, publicKey.W, address)) {
+						unsigned int bip44_path[BIP44_PATH_LEN];
+
+						uint32_t i;
+						for (i = 0; i < BIP44_PATH_LEN; i++) {
+							bip44_path[i] = (bip44_in[0] << 24) | (bip44_in[1] << 16) | (bip44_in[2] << 8) | (bip44_in[3]);
+							bip44_in += 4;
+						}
+						derive_public_key(bip44_path, &publicKey);
+
+						public_key_address(publicKey.W, address);
+					}
+					key_cache_add(bip44_bytes, publicKey.W, address);
+					display_address(address);
 					refresh_public_key_display();
 
 					// push the public key onto the response buffer.
@@ -315,6 +422,7 @@ static void constellation_main(void) {
 
 				case INS_BLIND_SIGN: { // RFC 6979
 					Timer_Restart();
+					drop_account_key_export();
 					
 					if(!blind_signing_enabled_bool){
 						ui_blind_singing_must_enable_message();
@@ -323,35 +431,77 @@ static void constellation_main(void) {
 
 					// check the third byte (0x02) for the instruction subtype.
 					if ((G_io_apdu_buffer[2] != P1_MORE) && (G_io_apdu_buffer[2] != P1_LAST)) {
-						hashTainted = 1;
+						operation = OP_NONE;
 						THROW(0x6A86);
 					}
 
-					unsigned char * in = G_io_apdu_buffer + APDU_HEADER_LENGTH;; 
-					unsigned int len = get_apdu_buffer_length(); 
-					 
-					if (hashTainted) { // if this is the first transaction chunk
-						hashTainted = 0;
+					// the fourth byte flags whether the host sends the hash of the message instead of the message.
+					if ((G_io_apdu_buffer[3] & ~P2_MSG_PREHASHED) != 0) {
+						operation = OP_NONE;
+						THROW(0x6B00);
+					}
+
+					unsigned char * in = G_io_apdu_buffer + APDU_HEADER_LENGTH;
+					unsigned int len = get_apdu_buffer_length();
+
+					// a prehashed message is one part, the sha512 that would have been computed here, then the bip44 path.
+					if (G_io_apdu_buffer[3] & P2_MSG_PREHASHED) {
+						// a digest signs like a transaction, so it has its own setting.
+						if (!prehashed_signing_enabled_bool) {
+							operation = OP_NONE;
+							THROW(0x6D47);
+						}
+						if ((operation != OP_NONE) || (G_io_apdu_buffer[2] != P1_LAST)) {
+							operation = OP_NONE;
+							THROW(0x6B00);
+						}
+						if (len != CX_SHA512_SIZE + BIP44_BYTE_LENGTH) {
+							operation = OP_NONE;
+							THROW(0x6D09);
+						}
+						operation_begin(OP_BLIND_SIGN_PREHASHED);
+						memmove(msg_hash, in, CX_SHA512_SIZE);
+						memmove(raw_tx, in + CX_SHA512_SIZE, BIP44_BYTE_LENGTH);
+						raw_tx_ix = BIP44_BYTE_LENGTH;
+						ui_top_blind_signing();
+						flags |= IO_ASYNCH_REPLY;
+						break;
+					}
+
+					// a part after the first must be of the message in flight, or its msg_left would be another operation's.
+					operation_continue(OP_BLIND_SIGN, 0x6B00);
+					if (operation == OP_NONE) { // if this is the first transaction chunk
+						if (len < MESSAGE_SIZE_LEN) {
+							THROW(0x6D08);
+						}
+						operation_begin(OP_BLIND_SIGN);
 						msg_len = get_msg_length();
-						// append message prefix, message length and delimeters to fresh buffer, 
-						init_msg_sign_buf(msg_len); // sets raw_tx_ix with packet size
-						in += 4;  // first packet has 4 extra bytes for message length
-						len -= 4; 				
-					} 
-
-					// update raw_tx_ix to the end of the buffer, to be ready for the next part of the tx.
-					if (raw_tx_ix + len > MAX_TX_RAW_LENGTH) {
-						hashTainted = 1;
-						THROW(0x6D08);
+						// start the hash with the message prefix, message length and delimeters.
+						init_msg_hash((unsigned int)msg_len);
+						in += MESSAGE_SIZE_LEN;  // first packet has 4 extra bytes for message length
+						len -= MESSAGE_SIZE_LEN;
 					}
 
-					// move the contents of the input buffer into raw_tx at raw_tx_ix offset
-					unsigned char * out = raw_tx + raw_tx_ix;
-					memcpy(out, in, len);
-					raw_tx_ix += len; // add packet length to raw_tx_ix offset
+					// hash the message straight out of the buffer, its declared length says where the bip44 path starts.
+					const unsigned int hash_len = (len < msg_left) ? len : msg_left;
+					cx_hash((cx_hash_t *)&msg_hash_context, 0, in, hash_len, NULL, 0);
+					msg_left -= hash_len;
 
-					// if this is the last part of the transaction, parse the transaction into human readable text, and display it.
+					// keep the bip44 path in raw_tx.
+					if (raw_tx_ix + (len - hash_len) > BIP44_BYTE_LENGTH) {
+						operation = OP_NONE;
+						THROW(0x6D08);
+					}
+					memmove(raw_tx + raw_tx_ix, in + hash_len, len - hash_len);
+					raw_tx_ix += len - hash_len;
+
+					// if this is the last part of the message, check all of it and the path came, finish the hash, and display the warning.
 					if (G_io_apdu_buffer[2] == P1_LAST) {
+						if ((msg_left != 0) || (raw_tx_ix != BIP44_BYTE_LENGTH)) {
+							operation = OP_NONE;
+							THROW(0x6D09);
+						}
+						cx_hash((cx_hash_t *)&msg_hash_context, CX_LAST, NULL, 0, msg_hash, sizeof(msg_hash));
 						ui_top_blind_signing();
 					}
 
@@ -365,13 +515,188 @@ static void constellation_main(void) {
 						
 				}
 				break;
+				// we're asked for the public keys of consecutive address indexes, to discover a wallet's addresses.
+				case INS_GET_PUBLIC_KEYS: {
+					Timer_Restart();
+
+					if (rx < APDU_HEADER_LENGTH + BIP44_BYTE_LENGTH + 1) {
+						operation = OP_NONE;
+						THROW(0x6D09);
+					}
+					if ((G_io_apdu_buffer[3] & ~P2_ADDRESSES) != 0) {
+						operation = OP_NONE;
+						THROW(0x6B00);
+					}
+					const bool addresses = (G_io_apdu_buffer[3] & P2_ADDRESSES) != 0;
+					const unsigned int entry_len = addresses ? ADDRESS_LEN : PUBLIC_KEY_LEN;
+
+					// the path of the first key, then how many keys are wanted.
+					unsigned char * bip44_in = G_io_apdu_buffer + APDU_HEADER_LENGTH;
+					unsigned int bip44_path[BIP44_PATH_LEN];
+					for (unsigned int i = 0; i < BIP44_PATH_LEN; i++) {
+						bip44_path[i] = (bip44_in[0] << 24) | (bip44_in[1] << 16) | (bip44_in[2] << 8) | (bip44_in[3]);
+						bip44_in += 4;
+					}
+
+					// as many as fit in the response, after their count, and ahead of the status word.
+					unsigned int count = (sizeof(G_io_apdu_buffer) - 1 - 2) / entry_len;
+					if (bip44_in[0] < count) {
+						count = bip44_in[0];
+					}
+					if ((count == 0) || (bip44_path[BIP44_PATH_LEN - 1] > UINT32_MAX - (count - 1))) {
+						operation = OP_NONE;
+						THROW(0x6D09);
+					}
+
+					// the keys are not shown, nor cached, so a scan does not push out the keys in use.
+					tx = 1;
+					for (unsigned int key_ix = 0; key_ix < count; key_ix++) {
+						cx_ecfp_public_key_t publicKey;
+						derive_public_key(bip44_path, &publicKey);
+						if (addresses) {
+							public_key_address(publicKey.W, (char *)G_io_apdu_buffer + tx);
+						} else {
+							memmove(G_io_apdu_buffer + tx, publicKey.W, PUBLIC_KEY_LEN);
+						}
+						tx += entry_len;
+						bip44_path[BIP44_PATH_LEN - 1]++;
+					}
+					G_io_apdu_buffer[0] = count;
+
+					// return 0x9000 OK.
+					THROW(0x9000);
+				}
+				break;
+
+				// we're asked for an account's public key and chain code, so the host can derive its addresses.
+				case INS_GET_ACCOUNT_KEY: {
+					Timer_Restart();
+
+					// a bad request drops whatever was being signed, but leaves an export the user is being asked about as it was.
+					if (rx < APDU_HEADER_LENGTH + BIP44_ACCOUNT_BYTE_LENGTH) {
+						if (operation != OP_EXPORT_ACCOUNT_KEY) {
+							operation = OP_NONE;
+						}
+						THROW(0x6D09);
+					}
+
+					// only an account of the app, m/44'/1137'/account', below it the host derives the change and index levels itself.
+					unsigned char * bip44_in = G_io_apdu_buffer + APDU_HEADER_LENGTH;
+					unsigned int path[BIP44_ACCOUNT_PATH_LEN];
+					for (unsigned int i = 0; i < BIP44_ACCOUNT_PATH_LEN; i++) {
+						path[i] = (bip44_in[0] << 24) | (bip44_in[1] << 16) | (bip44_in[2] << 8) | (bip44_in[3]);
+						bip44_in += 4;
+					}
+					if ((path[0] != BIP44_PURPOSE) || (path[1] != BIP44_COIN_TYPE) || ((path[2] & BIP32_HARDENED) == 0)) {
+						if (operation != OP_EXPORT_ACCOUNT_KEY) {
+							operation = OP_NONE;
+						}
+						THROW(0x6D46);
+					}
+					// the path a pending export shows is only replaced by one that passed.
+					memmove(account_key_path, path, sizeof(path));
+
+					// whatever was being signed is dropped, the pager is now the export's.
+					operation_begin(OP_EXPORT_ACCOUNT_KEY);
+					ui_top_export_account_key();
+
+					flags |= IO_ASYNCH_REPLY;
+				}
+				break;
+
+				// we're asked how well the public key cache is doing.
+				case INS_GET_KEY_CACHE_STATS: {
+					Timer_Restart();
+
+					const uint32_t hits = key_cache_hits();
+					const uint32_t misses = key_cache_misses();
+					G_io_apdu_buffer[0] = hits >> 24;
+					G_io_apdu_buffer[1] = hits >> 16;
+					G_io_apdu_buffer[2] = hits >> 8;
+					G_io_apdu_buffer[3] = hits;
+					G_io_apdu_buffer[4] = misses >> 24;
+					G_io_apdu_buffer[5] = misses >> 16;
+					G_io_apdu_buffer[6] = misses >> 8;
+					G_io_apdu_buffer[7] = misses;
+					tx = 8;
+					THROW(0x9000);
+				}
+				break;
+
+				// we're getting structured data to sign, in parts.
+				case INS_SIGN_DATA: {
+					Timer_Restart();
+					drop_account_key_export();
+
+					// the data is hashed without being kept, like a blind signed message, so it needs the same setting.
+					if(!blind_signing_enabled_bool){
+						ui_blind_singing_must_enable_message();
+						break;
+					}
+
+					// check the third byte (0x02) for the instruction subtype.
+					if ((G_io_apdu_buffer[2] != P1_MORE) && (G_io_apdu_buffer[2] != P1_LAST)) {
+						operation = OP_NONE;
+						THROW(0x6A86);
+					}
+					operation_continue(OP_SIGN_DATA, 0x6D40);
+
+					unsigned char * in = G_io_apdu_buffer + APDU_HEADER_LENGTH;
+					unsigned int len = get_apdu_buffer_length();
+
+					// the first part starts with the data length and the keys to show, which the header hashed ahead of the data needs.
+					if (operation == OP_NONE) {
+						operation_begin(OP_SIGN_DATA);
+						const unsigned int used = sign_data_begin(in, len);
+						in += used;
+						len -= used;
+
+						char header[SIGN_DATA_HEADER_MAX_LEN];
+						const unsigned int header_len = sign_data_header(header);
+						cx_sha512_init(&msg_hash_context);
+						cx_hash((cx_hash_t *)&msg_hash_context, 0, (const unsigned char *)header, header_len, NULL, 0);
+					}
+
+					// check and hash the data straight out of the buffer, only the bip44 path after it is kept, in raw_tx.
+					const unsigned int data_len = sign_data_chunk(in, len, sha512_text_sink, &msg_hash_context);
+					const unsigned int path_len = len - data_len;
+					if (raw_tx_ix + path_len > BIP44_BYTE_LENGTH) {
+						operation = OP_NONE;
+						THROW(0x6D44);
+					}
+					memmove(raw_tx + raw_tx_ix, in + data_len, path_len);
+					raw_tx_ix += path_len;
+
+					// if this is the last part, finish the hash, and display the picked values.
+					if (G_io_apdu_buffer[2] == P1_LAST) {
+						sign_data_end(sha512_text_sink, &msg_hash_context);
+						if (raw_tx_ix != BIP44_BYTE_LENGTH) {
+							operation = OP_NONE;
+							THROW(0x6D44);
+						}
+						cx_hash((cx_hash_t *)&msg_hash_context, CX_LAST, NULL, 0, msg_hash, sizeof(msg_hash));
+						curr_scr_ix = 0;
+						ui_top_sign_data();
+					}
+
+					flags |= IO_ASYNCH_REPLY;
+
+					// if this is not the last part, send 0x9000.
+					if (G_io_apdu_buffer[2] == P1_MORE) {
+						io_seproxyhal_touch_approve2(NULL);
+					}
+				}
+				break;
+
 				case 0xFF:                                                                                                                                 // return to dashboard
+					key_cache_wipe();
+					derive_node_wipe();
 					goto return_to_dashboard;
 
 				// we're asked to do an unknown command
 				default:
 					// return an error.
-					hashTainted = 1;
+					operation = OP_NONE;
 					THROW(0x6D00);
 					break;
 				}
@@ -453,6 +778,8 @@ unsigned char io_event(unsigned char channel) {
 			publicKeyNeedsRefresh = 0;
 		} else {
 			if (Timer_Expired()) {
+				key_cache_wipe();
+				derive_node_wipe();
 				os_sched_exit(0);
 			} else {
 				Timer_UpdateDisplay();
@@ -477,6 +804,8 @@ unsigned char io_event(unsigned char channel) {
 
 static void app_exit(void)
 {
+	key_cache_wipe();
+	derive_node_wipe();
 	BEGIN_TRY_L(exit) {
 		TRY_L(exit) {
 			os_sched_exit(-1);
@@ -495,8 +824,10 @@ __attribute__((section(".boot"))) int main(void) {
 	curr_scr_ix = 0;
 	max_scr_ix = 0;
 	raw_tx_ix = 0;
-	hashTainted = 1;
+	operation = OP_NONE;
 	uiState = UI_IDLE;
+	key_cache_wipe();
+	derive_node_wipe();
 
 	// First things first, we need to start the timer.
 	// If for some reason the 'io_event' callback is called with a ticker event,
@@ -1,15 +1,20 @@
 
 
 #include "shared.h"
+#include "selector.h"
+#include "format.h"
+#include "os.h"
 #include "string.h"
 #include <stdio.h>
 
-/** the position of the decimal point, 8 characters in from the right side */
+/** the position of the decimal point of a $DAG amount, 8 characters in from the right side */
 #define DECIMAL_PLACE_OFFSET 8
 
-#define MAX_BUFFER_LENGTH 128
+/** longest amount header, a '$', the ticker, and the NUL. */
+#define ASSET_HEADER_MAX_LEN (1 + TOKEN_TICKER_MAX_LEN + 1)
 
-unsigned char buffer[MAX_BUFFER_LENGTH];
+/** letters shown from each end of an address. */
+#define SHORT_ADDRESS_END_LEN 5
 
 static const char FROM_ADDRESS[] = "From Address\0";
 
@@ -21,116 +26,133 @@ static const char ELLIPSES[] = "...\0";
 
 static const char TXT_ASSET_DAG[] = "$DAG\0";
 
-/** returns the next byte in raw_tx and increments raw_tx_ix. If this would increment raw_tx_ix over the end of the buffer, throw an error. */
-static unsigned char next_raw_tx() {
-	if (raw_tx_ix < raw_tx_len) {
-		unsigned char retval = raw_tx[raw_tx_ix];
-		raw_tx_ix += 1;
-		return retval;
-	}
+static const char TXT_METAGRAPH[] = "Metagraph (host)\0";
 
-	return 0;
-}
+/** index of the next screen to fill. */
+static unsigned int select_scr_ix;
 
-/** fills the array in arr with the given number of bytes from raw_tx. */
-static void next_raw_tx_arr(unsigned char * arr, unsigned int length) {
-	for (unsigned int ix = 0; ix < length; ix++) {
-		*(arr + ix) = next_raw_tx();
-	}
-}
+/** the metagraph currency the amount is in, or NULL for $DAG. */
+static const token_info_t * select_token;
 
-/** parse the raw transaction in raw_tx and fill up the screens in tx_desc. */
-/** only parse out the send-to address and amount from the txos, skip the rest.  */
-void select_display_fields()
+void select_display_begin(void)
 {
-	unsigned int scr_ix = 0;
+	select_scr_ix = 0;
+	select_token = NULL;
+	memset(tx_desc, 0x00, sizeof(tx_desc));
+}
 
-	// Read the To and From address
-	unsigned char num_parents = next_raw_tx();
+void select_display_token(const token_info_t * token)
+{
+	select_token = token;
+}
 
-	for (int parent_ix = 0; parent_ix < num_parents; parent_ix++)
+/** puts the header on the next screen, and formats the value in tx under it. */
+static void select_value(const char * header, const unsigned int header_len, const unsigned char * tx, const tx_field_view_t * view, const unsigned int decimals)
+{
+	if (select_scr_ix >= MAX_TX_TEXT_SCREENS)
 	{
-		memset(buffer, 0x00, sizeof(buffer));
-		int buffer_len = next_raw_tx();
-
-		memset(buffer, 0x00, sizeof(buffer));
-		next_raw_tx_arr(buffer, buffer_len);
-
-		unsigned char *buffer_0 = buffer;
-		unsigned char *buffer_1 = buffer_0 + MAX_TX_TEXT_WIDTH;
-		unsigned char *buffer_2 = buffer_1 + MAX_TX_TEXT_WIDTH;
-
-		memset(tx_desc[scr_ix], '\0', CURR_TX_DESC_LEN);
-
-		auto const char *header = (parent_ix == 0) ? FROM_ADDRESS : TO_ADDRESS;
-		char shortAddress[20] = "";
-
-		char subBuffStart[5];
-		char subBuffEnd[5];
+		THROW(0x6D38);
+	}
 
-		memcpy(subBuffStart, &buffer_0[0], sizeof(subBuffStart));
-		memcpy(subBuffEnd, &buffer_2[strlen((const char *)buffer_2) - 5], sizeof(subBuffEnd));
+	memset(tx_desc[select_scr_ix], '\0', CURR_TX_DESC_LEN);
+	memmove(tx_desc[select_scr_ix][0], header, header_len);
+	format_display_value(select_scr_ix, tx + view->offset, view->len, decimals);
+	select_scr_ix++;
+}
 
-		strncat(shortAddress, &subBuffStart[0], sizeof(subBuffStart));
-		strncat(shortAddress, &ELLIPSES[0], sizeof(ELLIPSES));
-		strncat(shortAddress, &subBuffEnd[0], sizeof(subBuffEnd));
+/** shows the amount in tx, under the ticker and with the decimals of its currency. */
+static void select_amount(const unsigned char * tx, const tx_field_view_t * view)
+{
+	if (select_token == NULL)
+	{
+		select_value(TXT_ASSET_DAG, sizeof(TXT_ASSET_DAG), tx, view, DECIMAL_PLACE_OFFSET);
+		return;
+	}
 
-		memmove(tx_desc[scr_ix][0], header, MAX_TX_TEXT_WIDTH - 1);
-		memmove(tx_desc[scr_ix][1], shortAddress, MAX_TX_TEXT_WIDTH - 1);
-		memmove(tx_desc[scr_ix][2], TXT_BLANK, sizeof(TXT_BLANK));
+	char header[ASSET_HEADER_MAX_LEN];
+	const unsigned int ticker_len = strlen(select_token->ticker);
+	header[0] = '$';
+	memmove(header + 1, select_token->ticker, ticker_len);
+	header[1 + ticker_len] = '\0';
+	select_value(header, 1 + ticker_len + 1, tx, view, select_token->decimals);
+}
 
-		scr_ix++;
+/** puts the header on the next screen, and the first and last few letters of id under it. */
+static void select_short_id(const char * header, const char * id, const unsigned int id_len)
+{
+	if ((select_scr_ix >= MAX_TX_TEXT_SCREENS) || (id_len < SHORT_ADDRESS_END_LEN))
+	{
+		THROW(0x6D38);
 	}
 
-	// Read the Amount
-	int buffer_len = next_raw_tx();
-	char amount_length_char = buffer_len + '0';
-	memset(buffer, 0x00, sizeof(buffer));
-	next_raw_tx_arr(buffer, buffer_len);
+	char *short_id = tx_desc[select_scr_ix][1];
+	memset(tx_desc[select_scr_ix], '\0', CURR_TX_DESC_LEN);
+	memmove(tx_desc[select_scr_ix][0], header, strlen(header));
+	memmove(short_id, id, SHORT_ADDRESS_END_LEN);
+	memmove(short_id + SHORT_ADDRESS_END_LEN, ELLIPSES, strlen(ELLIPSES));
+	memmove(short_id + SHORT_ADDRESS_END_LEN + strlen(ELLIPSES), id + id_len - SHORT_ADDRESS_END_LEN, SHORT_ADDRESS_END_LEN);
 
-	memset(tx_desc[scr_ix], '\0', CURR_TX_DESC_LEN);
-
-	memmove(tx_desc[scr_ix][0], TXT_ASSET_DAG, sizeof(TXT_ASSET_DAG));
-	memmove(tx_desc[scr_ix][1], buffer, buffer_len);
-	memset(tx_desc[scr_ix][2], amount_length_char, sizeof(amount_length_char));
+	select_scr_ix++;
+}
 
-	scr_ix++;
+/** shows the first and last few letters of the address in tx, with the header for the sender or the receiver. */
+static void select_address(const unsigned char * tx, const tx_field_view_t * view)
+{
+	const char *header = (select_scr_ix == 0) ? FROM_ADDRESS : TO_ADDRESS;
+	select_short_id(header, (const char *)(tx + view->offset), view->len);
+}
 
-	// Skip last the tx ref
-	buffer_len = next_raw_tx();
-	memset(buffer, 0x00, sizeof(buffer));
-	next_raw_tx_arr(buffer, buffer_len);
+void select_display_field(const unsigned char * tx, const tx_field_view_t * view)
+{
+	switch (view->field)
+	{
+	case TX_FIELD_PARENT:
+		select_address(tx, view);
+		break;
 
-	// Skip the last tx ordinal
-	buffer_len = next_raw_tx();
-	memset(buffer, 0x00, sizeof(buffer));
-	next_raw_tx_arr(buffer, buffer_len);
+	case TX_FIELD_AMOUNT:
+		select_amount(tx, view);
+		break;
 
-	// Read the fee
-	buffer_len = next_raw_tx();
-	char fee_length_char = buffer_len + '0';
-	memset(buffer, 0x00, sizeof(buffer));
-	next_raw_tx_arr(buffer, buffer_len);
+	case TX_FIELD_FEE:
+		select_value(TXT_FEE, sizeof(TXT_FEE), tx, view, 0);
+		break;
 
-	memset(tx_desc[scr_ix], '\0', CURR_TX_DESC_LEN);
-	memmove(tx_desc[scr_ix][0], TXT_FEE, sizeof(TXT_FEE));
-	memmove(tx_desc[scr_ix][1], buffer, buffer_len);
-	memset(tx_desc[scr_ix][2], fee_length_char, sizeof(fee_length_char));
-	scr_ix++;
+	default:
+		// the parent count, last tx ref and salt are not displayed.
+		break;
+	}
+}
 
-	// Skip the Salt
-	buffer_len = next_raw_tx();
-	memset(buffer, 0x00, sizeof(buffer));
-	next_raw_tx_arr(buffer, buffer_len);
+void select_display_end(void)
+{
+	// the ticker is only the host's word for the metagraph, so the metagraph it named is shown to check it against.
+	if (select_token != NULL)
+	{
+		select_short_id(TXT_METAGRAPH, select_token->id, TOKEN_ID_LEN);
+	}
 
-	max_scr_ix = scr_ix;
+	max_scr_ix = select_scr_ix;
 
-	while (scr_ix < MAX_TX_TEXT_SCREENS)
+	for (unsigned int scr_ix = select_scr_ix; scr_ix < MAX_TX_TEXT_SCREENS; scr_ix++)
 	{
 		memmove(tx_desc[scr_ix][0], TXT_BLANK, sizeof(TXT_BLANK));
 		memmove(tx_desc[scr_ix][1], TXT_BLANK, sizeof(TXT_BLANK));
 		memmove(tx_desc[scr_ix][2], TXT_BLANK, sizeof(TXT_BLANK));
+	}
+}
 
-		scr_ix++;
+/** parse the raw transaction in raw_tx and fill up the screens in tx_desc. */
+/** only parse out the send-to address and amount from the txos, skip the rest.  */
+void select_display_fields()
+{
+	decode_begin(&KRYO_TX_V1_SCHEMA);
+	decode_fields(raw_tx_len);
+
+	select_display_begin();
+	for (unsigned int ix = 0; ix < tx_fields_len; ix++)
+	{
+		select_display_field(raw_tx, tx_fields + ix);
 	}
+	select_display_end();
 }
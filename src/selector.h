@@ -4,6 +4,20 @@
  */
 
 #include "shared.h"
+#include "decoder.h"
+#include "tokens.h"
 
 /** Select the raw transaction in raw_tx and fill up the screens in tx_desc. */
-void select_display_fields(void);
\ No newline at end of file
+void select_display_fields(void);
+
+/** clears the screens, before the fields are selected one at a time with select_display_field. */
+void select_display_begin(void);
+
+/** shows the amount in token's ticker and decimals, rather than in $DAG, until the next select_display_begin. */
+void select_display_token(const token_info_t * token);
+
+/** fills up and formats the screen for one decoded field of the transaction, if it is displayed. the view's offset is into tx. */
+void select_display_field(const unsigned char * tx, const tx_field_view_t * view);
+
+/** adds the screen of the metagraph of select_display_token, if any, and blanks the unused screens, once all the fields are selected. */
+void select_display_end(void);
\ No newline at end of file
@@ -19,10 +19,12 @@ static const char TXT_BLANK[] = "\0";
 /**
  * Nano S has 320 KB flash, 10 KB RAM, uses a ST31H320 chip.
  * This effectively limits the max size
- * So we can only display 9 screens of data, and can only sign transactions up to 1kb in size.
- * max size of a transaction, binary will not compile if we try to allow transactions over 1kb.
+ * So we can only display 9 screens of data.
+ * max size of a transaction kept whole for signing, without P2_STREAMED, bip44 path included.
+ * a v1 transaction, with its two parents, is about 200 bytes, anything longer has to be streamed.
+ * a streamed transaction holds back a field split across parts here, a length byte and up to 255 bytes, so it is no shorter than that.
  */
-#define MAX_TX_RAW_LENGTH 768
+#define MAX_TX_RAW_LENGTH 256
 
 /** raw transaction data. */
 extern unsigned char raw_tx[MAX_TX_RAW_LENGTH];
@@ -33,6 +35,39 @@ extern unsigned int raw_tx_ix;
 /** current length of raw transaction. */
 extern unsigned int raw_tx_len;
 
+/** length of BIP44 path */
+#define BIP44_PATH_LEN 5
+
+/** length of BIP44 path, in bytes */
+#define  BIP44_BYTE_LENGTH (BIP44_PATH_LEN * sizeof(unsigned int))
+
+/** length of the account level of a BIP44 path, m/44'/1137'/account' */
+#define BIP44_ACCOUNT_PATH_LEN 3
+
+/** length of the account level of a BIP44 path, in bytes */
+#define BIP44_ACCOUNT_BYTE_LENGTH (BIP44_ACCOUNT_PATH_LEN * sizeof(unsigned int))
+
+/** flag of a hardened BIP32 path level */
+#define BIP32_HARDENED 0x80000000
+
+/** the purpose level of a BIP44 path, 44' */
+#define BIP44_PURPOSE (BIP32_HARDENED | 44)
+
+/** the coin type level of a BIP44 path, 1137' */
+#define BIP44_COIN_TYPE (BIP32_HARDENED | 1137)
+
+/** length of a BIP32 chain code */
+#define CHAIN_CODE_LEN 32
+
+/** length of the public key */
+#define PUBLIC_KEY_LEN 65
+
+/** length of the suffix of the base58 key used for the address */
+#define BASE58_ENCODED_ADDRESS_SUFFIX_LEN 36
+
+/** length of a tx.output Address before encoding, which is the length of <address_version>+<script_hash>+<checksum> */
+#define ADDRESS_LEN (BASE58_ENCODED_ADDRESS_SUFFIX_LEN + 4)
+
 /** max number of bytes for one line of text. */
 #define CURR_TX_DESC_LEN (MAX_TX_TEXT_LINES * MAX_TX_TEXT_WIDTH)
 
@@ -41,6 +76,17 @@ extern unsigned int raw_tx_len;
 
 extern unsigned int max_scr_ix;
 
+/** fields of a transaction, in the order they appear in raw_tx. each is a length byte followed by that many bytes. */
+enum TX_FIELD {
+	TX_FIELD_PARENT_COUNT,
+	TX_FIELD_PARENT,
+	TX_FIELD_AMOUNT,
+	TX_FIELD_LAST_TX_REF_HASH,
+	TX_FIELD_LAST_TX_REF_ORDINAL,
+	TX_FIELD_FEE,
+	TX_FIELD_SALT
+};
+
 /** all text descriptions. */
 extern char tx_desc[MAX_TX_TEXT_SCREENS][MAX_TX_TEXT_LINES][MAX_TX_TEXT_WIDTH];
 
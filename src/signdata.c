@@ -0,0 +1,567 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+#include "signdata.h"
+#include "format.h"
+#include "os.h"
+#include <string.h>
+
+/** prefix of the signed text, ahead of the length of the base64 data. */
+static const char SIGN_DATA_PREFIX[] = "\x19" "Constellation Signed Data:\n";
+
+static const char TXT_SIGNED_DATA[] = "Signed Data\0";
+
+static const char TXT_BYTES[] = " bytes\0";
+
+static const char TXT_ABSENT[] = "(absent)\0";
+
+static const char ELLIPSES[] = "...\0";
+
+static const char BASE64_LETTERS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/** where the json reader is, between two bytes. */
+enum SIGN_DATA_JSON {
+	/** a value comes next. */
+	JSON_VALUE,
+	/** just after a '[', a value or the ']'. */
+	JSON_VALUE_OR_END,
+	/** just after a '{', a key or the '}'. */
+	JSON_KEY_OR_END,
+	/** after a ',' in an object, a key. */
+	JSON_KEY,
+	/** after a key, the ':'. */
+	JSON_COLON,
+	/** after a value, a ',' or the end of the object or array it is in. */
+	JSON_AFTER_VALUE,
+	/** in a key or a string value. */
+	JSON_STRING,
+	/** in a number. */
+	JSON_NUMBER,
+	/** in a true, false or null. */
+	JSON_LITERAL,
+	/** after the top level object, no more data can follow. */
+	JSON_DONE
+};
+
+/** where the reader is in a number, by the json grammar: an optional '-', 0 or a digit 1 to 9 and more digits, an optional fraction, an optional exponent. */
+enum SIGN_DATA_NUMBER {
+	/** after the '-', the first digit. */
+	NUMBER_MINUS,
+	/** after a leading 0, no more integer digits. */
+	NUMBER_ZERO,
+	/** in the integer digits. */
+	NUMBER_INTEGER,
+	/** after the '.', a fraction digit. */
+	NUMBER_POINT,
+	/** in the fraction digits. */
+	NUMBER_FRACTION,
+	/** after the 'e' or 'E', the exponent's sign or a digit. */
+	NUMBER_EXPONENT_MARK,
+	/** after the exponent's sign, a digit. */
+	NUMBER_EXPONENT_SIGN,
+	/** in the exponent digits. */
+	NUMBER_EXPONENT,
+	/** the letter is not part of the number. */
+	NUMBER_END
+};
+
+/** after a '\' in a string, the escape letter comes next. */
+#define ESCAPE_LETTER 5
+
+/** no key's value is being shown. */
+#define NO_CAPTURE 0xFF
+
+/** letters of a value shown on the two lines under its key. */
+#define CAPTURE_MAX_LEN (2 * (MAX_TX_TEXT_WIDTH - 1))
+
+/** the data being signed, and how far the reader has got through it. */
+static struct {
+	/** length of the data, from the first chunk. */
+	uint32_t data_len;
+	/** bytes of the data read so far. */
+	uint32_t data_ix;
+
+	/** where the json reader is, from enum SIGN_DATA_JSON. */
+	unsigned char state;
+	/** number of objects and arrays the reader is in. */
+	unsigned char depth;
+	/** bit n is set if the container at depth n + 1 is an object. */
+	uint32_t objects;
+	/** where the reader is in the number being read, from enum SIGN_DATA_NUMBER. */
+	unsigned char number_part;
+	/** set if the string being read is a key. */
+	bool string_is_key;
+	/** hex digits of a \u escape left to read, or ESCAPE_LETTER just after the '\'. */
+	unsigned char escape_left;
+	/** the \u escape read so far. */
+	unsigned int escape_code;
+	/** the true, false or null being read. */
+	const char * literal;
+	/** letters of the literal read so far. */
+	unsigned char literal_ix;
+
+	/** the key being read. */
+	char key[SIGN_DATA_MAX_ORDERED_KEY_LEN];
+	unsigned char key_len;
+	/** the last key of each object the reader is in, outermost first, every key must sort after the one before it. */
+	char last_keys[SIGN_DATA_LAST_KEYS_LEN];
+	/** where the last key of the container at depth n + 1 starts in last_keys, arrays keep an empty one. */
+	unsigned char last_key_starts[SIGN_DATA_MAX_DEPTH];
+	unsigned char last_key_lens[SIGN_DATA_MAX_DEPTH];
+	/** bit n is set once the object at depth n + 1 has had a key. */
+	uint32_t has_last_key;
+
+	/** the keys the host picked to show. */
+	char keys[SIGN_DATA_MAX_KEYS][SIGN_DATA_MAX_KEY_LEN];
+	unsigned char key_lens[SIGN_DATA_MAX_KEYS];
+	unsigned char keys_len;
+	/** index in keys of the key whose value is being shown, or NO_CAPTURE. */
+	unsigned char capture;
+	/** letters of the value shown so far. */
+	unsigned char capture_len;
+
+	/** bytes of data waiting for a full group of three to base64 encode. */
+	unsigned char base64[3];
+	unsigned char base64_len;
+} sign_data;
+
+/** the data does not follow the canonical json form. */
+static void not_canonical(void) {
+	THROW(0x6D41);
+}
+
+static bool in_object(void) {
+	return (sign_data.depth > 0) && ((sign_data.objects >> (sign_data.depth - 1)) & 1);
+}
+
+static bool is_digit(const unsigned char c) {
+	return (c >= '0') && (c <= '9');
+}
+
+/** returns where the letter c takes the reader from part of a number, or NUMBER_END if c is not part of it. */
+static unsigned char number_next(const unsigned char part, const unsigned char c) {
+	switch(part) {
+	case NUMBER_MINUS:
+		if(c == '0') {
+			return NUMBER_ZERO;
+		}
+		return is_digit(c) ? NUMBER_INTEGER : NUMBER_END;
+	case NUMBER_INTEGER:
+		if(is_digit(c)) {
+			return NUMBER_INTEGER;
+		}
+		// fall through
+	case NUMBER_ZERO:
+		if(c == '.') {
+			return NUMBER_POINT;
+		}
+		return ((c == 'e') || (c == 'E')) ? NUMBER_EXPONENT_MARK : NUMBER_END;
+	case NUMBER_POINT:
+		return is_digit(c) ? NUMBER_FRACTION : NUMBER_END;
+	case NUMBER_FRACTION:
+		if(is_digit(c)) {
+			return NUMBER_FRACTION;
+		}
+		return ((c == 'e') || (c == 'E')) ? NUMBER_EXPONENT_MARK : NUMBER_END;
+	case NUMBER_EXPONENT_MARK:
+		if((c == '+') || (c == '-')) {
+			return NUMBER_EXPONENT_SIGN;
+		}
+		// fall through
+	case NUMBER_EXPONENT_SIGN:
+	case NUMBER_EXPONENT:
+		return is_digit(c) ? NUMBER_EXPONENT : NUMBER_END;
+	default:
+		return NUMBER_END;
+	}
+}
+
+/** returns true if a number can end at part, it does not end on a '-', '.', 'e' or exponent sign. */
+static bool number_complete(const unsigned char part) {
+	return (part == NUMBER_ZERO) || (part == NUMBER_INTEGER) || (part == NUMBER_FRACTION) || (part == NUMBER_EXPONENT);
+}
+
+/** returns true if the character escaped as \u00XX has a two letter escape, which canonical json uses instead. */
+static bool has_short_escape(const unsigned int code) {
+	return (code == '\b') || (code == '\f') || (code == '\n') || (code == '\r') || (code == '\t');
+}
+
+static int hex_value(const unsigned char c) {
+	if((c >= '0') && (c <= '9')) {
+		return c - '0';
+	}
+	if((c >= 'a') && (c <= 'f')) {
+		return c - 'a' + 10;
+	}
+	if((c >= 'A') && (c <= 'F')) {
+		return c - 'A' + 10;
+	}
+	return -1;
+}
+
+/** adds a letter of the value being shown to the two lines under its key, ending them with ellipses if it runs over. */
+static void capture_letter(const unsigned char c) {
+	char (*screen)[MAX_TX_TEXT_WIDTH] = tx_desc[1 + sign_data.capture];
+	if(sign_data.capture_len == CAPTURE_MAX_LEN) {
+		memmove(screen[2] + MAX_TX_TEXT_WIDTH - 1 - strlen(ELLIPSES), ELLIPSES, strlen(ELLIPSES));
+		return;
+	}
+	const unsigned int line = 1 + (sign_data.capture_len / (MAX_TX_TEXT_WIDTH - 1));
+	screen[line][sign_data.capture_len % (MAX_TX_TEXT_WIDTH - 1)] = c;
+	sign_data.capture_len++;
+}
+
+/** returns true if c is part of the value being shown, the quotes around a string and what ends a number are not. */
+static bool is_captured(const unsigned char c) {
+	if(sign_data.capture == NO_CAPTURE) {
+		return false;
+	}
+	if(sign_data.depth > 1) {
+		return true;
+	}
+	switch(sign_data.state) {
+	case JSON_VALUE:
+		return c != '"';
+	case JSON_STRING:
+		return (c != '"') || (sign_data.escape_left != 0);
+	case JSON_NUMBER:
+		return number_next(sign_data.number_part, c) != NUMBER_END;
+	case JSON_LITERAL:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/** a value just ended, at the current depth. */
+static void value_done(void) {
+	if(sign_data.depth == 1) {
+		sign_data.capture = NO_CAPTURE;
+	}
+	sign_data.state = (sign_data.depth == 0) ? JSON_DONE : JSON_AFTER_VALUE;
+}
+
+/** a key just ended, it is checked against the one before in its object, and a top level key is shown if it was picked. */
+static void key_done(void) {
+	sign_data.state = JSON_COLON;
+
+	// canonical json sorts the keys of every object, which also rules out the same key twice.
+	const unsigned int level = sign_data.depth - 1;
+	const uint32_t level_bit = (uint32_t)1 << level;
+	char * last_key = sign_data.last_keys + sign_data.last_key_starts[level];
+	const unsigned int last_key_len = sign_data.last_key_lens[level];
+	if(sign_data.has_last_key & level_bit) {
+		const unsigned int common_len = (sign_data.key_len < last_key_len) ? sign_data.key_len : last_key_len;
+		const int order = memcmp(last_key, sign_data.key, common_len);
+		if((order > 0) || ((order == 0) && (last_key_len >= sign_data.key_len))) {
+			not_canonical();
+		}
+	}
+	// the objects inside this one are closed, so its last key is the top of last_keys.
+	if(sign_data.last_key_starts[level] + sign_data.key_len > SIGN_DATA_LAST_KEYS_LEN) {
+		THROW(0x6D42);
+	}
+	memmove(last_key, sign_data.key, sign_data.key_len);
+	sign_data.last_key_lens[level] = sign_data.key_len;
+	sign_data.has_last_key |= level_bit;
+
+	if(sign_data.depth != 1) {
+		return;
+	}
+	for(unsigned int ix = 0; ix < sign_data.keys_len; ix++) {
+		if((sign_data.key_lens[ix] == sign_data.key_len) && (memcmp(sign_data.keys[ix], sign_data.key, sign_data.key_len) == 0)) {
+			sign_data.capture = ix;
+			sign_data.capture_len = 0;
+			memset(tx_desc[1 + ix][1], '\0', MAX_TX_TEXT_WIDTH);
+		}
+	}
+}
+
+static void string_byte(const unsigned char c) {
+	if(sign_data.escape_left == ESCAPE_LETTER) {
+		if(c == 'u') {
+			sign_data.escape_left = 4;
+			sign_data.escape_code = 0;
+		} else if((c == '"') || (c == '\\') || (c == 'b') || (c == 'f') || (c == 'n') || (c == 'r') || (c == 't')) {
+			sign_data.escape_left = 0;
+		} else {
+			not_canonical();
+		}
+	} else if(sign_data.escape_left > 0) {
+		const int digit = hex_value(c);
+		if(digit < 0) {
+			not_canonical();
+		}
+		sign_data.escape_code = (sign_data.escape_code << 4) | digit;
+		sign_data.escape_left--;
+		// canonical json only uses \u for control characters, and the shortest escape of each.
+		if((sign_data.escape_left == 0) && ((sign_data.escape_code >= 0x20) || has_short_escape(sign_data.escape_code))) {
+			not_canonical();
+		}
+	} else if(c == '\\') {
+		sign_data.escape_left = ESCAPE_LETTER;
+	} else if(c == '"') {
+		if(sign_data.string_is_key) {
+			key_done();
+		} else {
+			value_done();
+		}
+		return;
+	} else if(c < 0x20) {
+		not_canonical();
+	}
+
+	if(sign_data.string_is_key) {
+		if(sign_data.key_len == SIGN_DATA_MAX_ORDERED_KEY_LEN) {
+			THROW(0x6D42);
+		}
+		sign_data.key[sign_data.key_len++] = c;
+	}
+}
+
+static void open_container(const bool is_object) {
+	if(sign_data.depth == SIGN_DATA_MAX_DEPTH) {
+		THROW(0x6D42);
+	}
+	if(is_object) {
+		sign_data.objects |= ((uint32_t)1 << sign_data.depth);
+	} else {
+		sign_data.objects &= ~((uint32_t)1 << sign_data.depth);
+	}
+	// the container's keys go after the last key of the one it is in, it has none yet.
+	const unsigned int level = sign_data.depth;
+	sign_data.last_key_starts[level] = (level == 0) ? 0 : (sign_data.last_key_starts[level - 1] + sign_data.last_key_lens[level - 1]);
+	sign_data.last_key_lens[level] = 0;
+	sign_data.has_last_key &= ~((uint32_t)1 << level);
+	sign_data.depth++;
+	sign_data.state = is_object ? JSON_KEY_OR_END : JSON_VALUE_OR_END;
+}
+
+static void close_container(const unsigned char c) {
+	if(c != (in_object() ? '}' : ']')) {
+		not_canonical();
+	}
+	sign_data.depth--;
+	value_done();
+}
+
+static void start_value(const unsigned char c) {
+	// the data is always an object, so it has keys to show.
+	if((sign_data.depth == 0) && (c != '{')) {
+		not_canonical();
+	}
+	switch(c) {
+	case '{':
+		open_container(true);
+		break;
+	case '[':
+		open_container(false);
+		break;
+	case '"':
+		sign_data.state = JSON_STRING;
+		sign_data.string_is_key = false;
+		break;
+	case 't':
+	case 'f':
+	case 'n':
+		sign_data.state = JSON_LITERAL;
+		sign_data.literal = (c == 't') ? "true" : ((c == 'f') ? "false" : "null");
+		sign_data.literal_ix = 1;
+		break;
+	default:
+		// a number starts with its '-' or its first digit, which is read as if after a '-'.
+		sign_data.number_part = (c == '-') ? NUMBER_MINUS : number_next(NUMBER_MINUS, c);
+		if(sign_data.number_part == NUMBER_END) {
+			not_canonical();
+		}
+		sign_data.state = JSON_NUMBER;
+		break;
+	}
+}
+
+/** reads one byte of json. there is no whitespace outside strings in canonical json. */
+static void json_byte(const unsigned char c) {
+	if(is_captured(c)) {
+		capture_letter(c);
+	}
+
+	switch(sign_data.state) {
+	case JSON_STRING:
+		string_byte(c);
+		return;
+	case JSON_LITERAL:
+		if(c != (unsigned char)sign_data.literal[sign_data.literal_ix]) {
+			not_canonical();
+		}
+		sign_data.literal_ix++;
+		if(sign_data.literal[sign_data.literal_ix] == '\0') {
+			value_done();
+		}
+		return;
+	case JSON_NUMBER: {
+		const unsigned char part = number_next(sign_data.number_part, c);
+		if(part != NUMBER_END) {
+			sign_data.number_part = part;
+			return;
+		}
+		// the letter after a number ends it, if it has all its digits, and is read as what comes after the value.
+		if(!number_complete(sign_data.number_part)) {
+			not_canonical();
+		}
+		value_done();
+		break;
+	}
+	default:
+		break;
+	}
+
+	switch(sign_data.state) {
+	case JSON_VALUE_OR_END:
+		if(c == ']') {
+			close_container(c);
+			return;
+		}
+		start_value(c);
+		return;
+	case JSON_VALUE:
+		start_value(c);
+		return;
+	case JSON_KEY_OR_END:
+		if(c == '}') {
+			close_container(c);
+			return;
+		}
+		// fall through
+	case JSON_KEY:
+		if(c != '"') {
+			not_canonical();
+		}
+		sign_data.state = JSON_STRING;
+		sign_data.string_is_key = true;
+		sign_data.key_len = 0;
+		return;
+	case JSON_COLON:
+		if(c != ':') {
+			not_canonical();
+		}
+		sign_data.state = JSON_VALUE;
+		return;
+	case JSON_AFTER_VALUE:
+		if(c == ',') {
+			sign_data.state = in_object() ? JSON_KEY : JSON_VALUE;
+			return;
+		}
+		close_container(c);
+		return;
+	default:
+		not_canonical();
+	}
+}
+
+/** writes the four base64 letters of a group of three bytes. */
+static void base64_group(const unsigned char * group, char * letters) {
+	letters[0] = BASE64_LETTERS[group[0] >> 2];
+	letters[1] = BASE64_LETTERS[((group[0] & 0x03) << 4) | (group[1] >> 4)];
+	letters[2] = BASE64_LETTERS[((group[1] & 0x0F) << 2) | (group[2] >> 6)];
+	letters[3] = BASE64_LETTERS[group[2] & 0x3F];
+}
+
+/** adds a byte to the base64 encoding, each group of three adds four letters to letters. */
+static void base64_byte(const unsigned char c, char * letters, unsigned int * letters_len) {
+	sign_data.base64[sign_data.base64_len++] = c;
+	if(sign_data.base64_len == 3) {
+		base64_group(sign_data.base64, letters + *letters_len);
+		*letters_len += 4;
+		sign_data.base64_len = 0;
+	}
+}
+
+unsigned int sign_data_begin(const unsigned char * in, const unsigned int in_len) {
+	memset(&sign_data, 0x00, sizeof(sign_data));
+	sign_data.capture = NO_CAPTURE;
+	sign_data.state = JSON_VALUE;
+
+	if(in_len < 5) {
+		THROW(0x6D40);
+	}
+	sign_data.data_len = ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | in[3];
+	sign_data.keys_len = in[4];
+	if(sign_data.keys_len > SIGN_DATA_MAX_KEYS) {
+		THROW(0x6D40);
+	}
+
+	unsigned int ix = 5;
+	for(unsigned int key_ix = 0; key_ix < sign_data.keys_len; key_ix++) {
+		if(ix >= in_len) {
+			THROW(0x6D40);
+		}
+		const unsigned int key_len = in[ix++];
+		if((key_len == 0) || (key_len > SIGN_DATA_MAX_KEY_LEN) || (key_len > in_len - ix)) {
+			THROW(0x6D40);
+		}
+		memmove(sign_data.keys[key_ix], in + ix, key_len);
+		sign_data.key_lens[key_ix] = key_len;
+		ix += key_len;
+	}
+
+	// the size of the data, then each picked key, until its value goes by.
+	memset(tx_desc, 0x00, sizeof(tx_desc));
+	memmove(tx_desc[0][0], TXT_SIGNED_DATA, sizeof(TXT_SIGNED_DATA));
+	const unsigned int digits_len = format_fixed_point(sign_data.data_len, 0, true, false, tx_desc[0][1], MAX_TX_TEXT_WIDTH - sizeof(TXT_BYTES));
+	memmove(tx_desc[0][1] + digits_len, TXT_BYTES, sizeof(TXT_BYTES));
+	for(unsigned int key_ix = 0; key_ix < sign_data.keys_len; key_ix++) {
+		memmove(tx_desc[1 + key_ix][0], sign_data.keys[key_ix], sign_data.key_lens[key_ix]);
+		memmove(tx_desc[1 + key_ix][1], TXT_ABSENT, sizeof(TXT_ABSENT));
+	}
+	max_scr_ix = 1 + sign_data.keys_len;
+	return ix;
+}
+
+unsigned int sign_data_header(char * buffer) {
+	const uint64_t base64_len = 4 * (((uint64_t)sign_data.data_len + 2) / 3);
+	unsigned int header_len = sizeof(SIGN_DATA_PREFIX) - 1;
+	memmove(buffer, SIGN_DATA_PREFIX, header_len);
+	header_len += format_fixed_point(base64_len, 0, false, false, buffer + header_len, SIGN_DATA_HEADER_MAX_LEN - header_len);
+	buffer[header_len++] = '\n';
+	return header_len;
+}
+
+unsigned int sign_data_chunk(const unsigned char * in, const unsigned int in_len, text_sink_t sink, void * context) {
+	char letters[SIGN_DATA_SINK_CHUNK_LEN];
+	unsigned int letters_len = 0;
+
+	unsigned int ix = 0;
+	while((ix < in_len) && (sign_data.data_ix < sign_data.data_len)) {
+		const unsigned char c = in[ix++];
+		sign_data.data_ix++;
+		json_byte(c);
+		base64_byte(c, letters, &letters_len);
+		if(letters_len > sizeof(letters) - 4) {
+			sink(context, letters, letters_len);
+			letters_len = 0;
+		}
+	}
+	if(letters_len > 0) {
+		sink(context, letters, letters_len);
+	}
+	return ix;
+}
+
+void sign_data_end(text_sink_t sink, void * context) {
+	if(sign_data.data_ix != sign_data.data_len) {
+		THROW(0x6D43);
+	}
+	if(sign_data.state != JSON_DONE) {
+		not_canonical();
+	}
+
+	if(sign_data.base64_len > 0) {
+		// pad the last group with zero bits, and the letters it does not have with '='.
+		char letters[4];
+		memset(sign_data.base64 + sign_data.base64_len, 0x00, 3 - sign_data.base64_len);
+		base64_group(sign_data.base64, letters);
+		memset(letters + sign_data.base64_len + 1, '=', 3 - sign_data.base64_len);
+		sink(context, letters, sizeof(letters));
+	}
+}
@@ -0,0 +1,53 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+#ifndef SIGNDATA_H
+#define SIGNDATA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hex.h"
+#include "shared.h"
+
+/** most top level keys the host can pick to show, each takes a screen after the size screen. */
+#define SIGN_DATA_MAX_KEYS 3
+
+/** longest key the host can pick to show, it is the header line of its screen. */
+#define SIGN_DATA_MAX_KEY_LEN (MAX_TX_TEXT_WIDTH - 1)
+
+/** longest key, each is kept until the next one in its object, to check they are in order. */
+#define SIGN_DATA_MAX_ORDERED_KEY_LEN 32
+
+/** room for the last key of every object the reader is in at once, the keys along the nesting share it. */
+#define SIGN_DATA_LAST_KEYS_LEN 96
+
+/** deepest nesting of objects and arrays. */
+#define SIGN_DATA_MAX_DEPTH 32
+
+/** longest header hashed ahead of the base64 text, the prefix, up to 11 digits of base64 length, and a newline. */
+#define SIGN_DATA_HEADER_MAX_LEN 40
+
+/** number of base64 letters sign_data_chunk hands to the sink at a time. */
+#define SIGN_DATA_SINK_CHUNK_LEN 64
+
+/**
+ * starts signing structured data, reading what precedes it in the first chunk, in_len bytes of in:
+ * the 4 byte big-endian length of the data, the number of keys to show, and each key, after its length.
+ * fills tx_desc with the size screen and a screen per key, and returns the number of bytes read.
+ */
+unsigned int sign_data_begin(const unsigned char * in, const unsigned int in_len);
+
+/** writes the header that is hashed ahead of the base64 text into buffer, and returns its length. */
+unsigned int sign_data_header(char * buffer);
+
+/**
+ * checks the data in in_len bytes of in is canonical json, shows the values of the picked keys as they go by,
+ * and sends its base64 encoding to sink. returns the number of bytes of data, anything after them is the bip44 path.
+ */
+unsigned int sign_data_chunk(const unsigned char * in, const unsigned int in_len, text_sink_t sink, void * context);
+
+/** checks all the data arrived, and was one whole json object, then sends the end of the base64 to sink. */
+void sign_data_end(text_sink_t sink, void * context);
+
+#endif // SIGNDATA_H
@@ -0,0 +1,63 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+#include "tokens.h"
+#include <stddef.h>
+#include <string.h>
+
+/** the file the registry entries are read from, a test build can point it at its own. */
+#ifndef TOKEN_REGISTRY
+#define TOKEN_REGISTRY "tokens.def"
+#endif
+
+/** zero, but fails the build, as a negative array size, for an entry with more than TOKEN_DECIMALS_MAX decimals. */
+#define TOKEN_CHECK_DECIMALS(decimals) (0 * sizeof(char[((decimals) <= TOKEN_DECIMALS_MAX) ? 1 : -1]))
+
+#define TOKEN(id, ticker, decimals) { id, ticker, (decimals) + TOKEN_CHECK_DECIMALS(decimals) },
+
+/** the registry, sorted by identifier. it lives in flash, with the rest of the constants. */
+static const token_info_t TOKENS[] = {
+#include TOKEN_REGISTRY
+	// keeps the table from being empty, it is not part of the registry, and never searched.
+	{ "", "", 0 }
+};
+
+#undef TOKEN
+#undef TOKEN_CHECK_DECIMALS
+
+/** number of entries in TOKENS, without the end marker. */
+#define TOKENS_LEN ((sizeof(TOKENS) / sizeof(TOKENS[0])) - 1)
+
+const token_info_t * token_find(const unsigned char * id, const unsigned int id_len) {
+	if(id_len != TOKEN_ID_LEN) {
+		return NULL;
+	}
+
+	unsigned int low = 0;
+	unsigned int high = TOKENS_LEN;
+	while(low < high) {
+		const unsigned int mid = low + ((high - low) / 2);
+		const int cmp = memcmp(id, TOKENS[mid].id, TOKEN_ID_LEN);
+		if(cmp == 0) {
+			return TOKENS + mid;
+		}
+		if(cmp < 0) {
+			high = mid;
+		} else {
+			low = mid + 1;
+		}
+	}
+	return NULL;
+}
+
+unsigned int token_count(void) {
+	return TOKENS_LEN;
+}
+
+const token_info_t * token_at(const unsigned int ix) {
+	if(ix >= TOKENS_LEN) {
+		return NULL;
+	}
+	return TOKENS + ix;
+}
@@ -0,0 +1,41 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+#ifndef TOKENS_H
+#define TOKENS_H
+
+#include <stdint.h>
+
+/** length of a metagraph identifier, the DAG address of the metagraph. */
+#define TOKEN_ID_LEN 40
+
+/** longest ticker, without the '$' it is shown with. */
+#define TOKEN_TICKER_MAX_LEN 8
+
+/** most decimals a currency can have, 10^19 being the largest power of ten an amount, a uint64, holds, so one whole token is an amount. */
+#define TOKEN_DECIMALS_MAX 19
+
+/**
+ * a metagraph currency the app can clear sign transfers of.
+ * the strings are arrays rather than pointers, so the table needs no relocation in flash.
+ */
+typedef struct {
+	/** the metagraph identifier, not NUL terminated. */
+	char id[TOKEN_ID_LEN];
+	/** the ticker, NUL terminated. */
+	char ticker[TOKEN_TICKER_MAX_LEN + 1];
+	/** decimal places of the amounts of the currency. */
+	uint8_t decimals;
+} token_info_t;
+
+/** returns the registry entry for the id_len byte metagraph identifier id, or NULL if it is not in the registry. */
+const token_info_t * token_find(const unsigned char * id, const unsigned int id_len);
+
+/** number of tokens in the registry. */
+unsigned int token_count(void);
+
+/** returns the registry entry at ix, in order of identifier. */
+const token_info_t * token_at(const unsigned int ix);
+
+#endif // TOKENS_H
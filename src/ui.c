@@ -3,12 +3,16 @@
  */
 
 #include "ui.h"
+#include "constellation.h"
 #include "glyphs.h"
 #include "base-encoding.h"
 #include <stdio.h>
 #include <stdbool.h>
 #include <math.h>
 #include "shared.h"
+#include "keycache.h"
+#include "keyderive.h"
+#include "format.h"
 
 /** default font */
 #define DEFAULT_FONT BAGL_FONT_OPEN_SANS_EXTRABOLD_11px | BAGL_FONT_ALIGNMENT_CENTER
@@ -31,14 +35,12 @@ char timer_desc[MAX_TIMER_TEXT_WIDTH];
 /** UI state enum */
 enum UI_STATE uiState;
 
-/** notification to restart the hash */
-unsigned char hashTainted;
+/** operation in flight, OP_NONE when the next part starts a new one */
+enum OPERATION operation;
 
 /** notification to refresh the view, if we are displaying the public key */
 unsigned char publicKeyNeedsRefresh;
 
-static const char BASE_16_ALPHABET[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
-
 /** index of the current screen. */
 unsigned int curr_scr_ix;
 
@@ -54,34 +56,57 @@ char curr_tx_desc[MAX_TX_TEXT_LINES][MAX_TX_TEXT_WIDTH];
 /** currently displayed public key */
 char current_public_key[MAX_TX_TEXT_LINES][MAX_TX_TEXT_WIDTH];
 
-/** hash to go into kryto serialize */
-unsigned char hash_data[HASH_DATA_SIZE];
+/** sha256 of the kryo serialization of the transaction. */
+unsigned char tx_hash[CX_SHA256_SIZE];
+
+unsigned int account_key_path[BIP44_ACCOUNT_PATH_LEN];
+
+/** title of the account screen of an account key export. */
+static const char TXT_ACCOUNT[] = "Account\0";
+
+/** title of the fingerprint screen of a prehashed message. */
+static const char TXT_DIGEST[] = "Digest\0";
+
+unsigned char msg_hash[CX_SHA512_SIZE];
 
 /** Is blind signing enabled */
 bool blind_signing_enabled_bool = false;
 
-/** hash ix to go into kryto serialize */
-unsigned int hash_data_ix;
+/** Is blind signing of a digest the host hashed enabled */
+bool prehashed_signing_enabled_bool = false;
 
-static const unsigned char KRYO_PREFIX[] = {0x03};
+/** length of the kryo text serialization of the transaction. */
+unsigned int tx_text_len;
 
 /** UI was touched indicating the user wants to deny te signature request */
 static const bagl_element_t * io_seproxyhal_touch_deny(const bagl_element_t *e);
 
+/** UI was touched indicating the user wants to export the account key */
+static const bagl_element_t * io_seproxyhal_touch_approve_account_key(const bagl_element_t *e);
+
 /** UI was touched indicating the user wants to enable blind signing */
 static const bagl_element_t * io_seproxyhal_touch_enable_blind_signing(const bagl_element_t *e);
 
 /** UI was touched indicating the user wants to disable blind signing */
 static const bagl_element_t * io_seproxyhal_touch_disable_blind_signing(const bagl_element_t *e);
 
+/** UI was touched indicating the user wants to enable blind signing of prehashed messages */
+static const bagl_element_t * io_seproxyhal_touch_enable_prehashed_signing(const bagl_element_t *e);
+
+/** UI was touched indicating the user wants to disable blind signing of prehashed messages */
+static const bagl_element_t * io_seproxyhal_touch_disable_prehashed_signing(const bagl_element_t *e);
+
 /** Show the UI for the blind signing settings */
 void ui_blind_signing_settings(void);
 
-#if defined(TARGET_NANOS)
+/** Show the UI for the prehashed message setting */
+static void ui_prehashed_signing_settings(void);
 
 /** UI was touched indicating the user wants to exit the app */
 static const bagl_element_t * io_seproxyhal_touch_exit(const bagl_element_t *e);
 
+#if defined(TARGET_NANOS)
+
 /** display part of the transaction description */
 static void ui_display_tx_desc_1(void);
 
@@ -91,6 +116,9 @@ void ui_idle_settings(void);
 /** show the UI for warning a blind signing */
 void ui_blind_signing_warning(void);
 
+/** show the fingerprint of a prehashed message's digest */
+void ui_blind_signing_digest(void);
+
 /** show the UI for signing a message */
 void ui_blind_signing_accept(void);
 
@@ -106,15 +134,15 @@ static void ui_sign(void);
 /** display the UI for denying a transaction */
 static void ui_deny(void);
 
+/** show the top screen of the pager again, as it was labelled */
+static void ui_top_review(void);
+
 /** move up in the transaction description list */
 static const bagl_element_t * tx_desc_up(const bagl_element_t *e);
 
 /** move down in the transaction description list */
 static const bagl_element_t * tx_desc_dn(const bagl_element_t *e);
 
-/** UI was touched indicating the user wants to exit the app */
-static const bagl_element_t * io_seproxyhal_touch_exit(const bagl_element_t *e);
-
 /** display part of the transaction description */
 static void ui_display_tx_desc_1(void);
 
@@ -174,20 +202,6 @@ UX_STEP_VALID(
 		"NOT Enabled"
 
 	});
-UX_STEP_VALID(
-    ux_blind_signing_disabled_go_back,
-    bb,
-    io_seproxyhal_touch_to_idle(NULL),
-    {	
-		"Back",
-        "",
-	});
-
-UX_FLOW(ux_settings_blind_signing_disabled_flow,
-	&ux_blind_signing_disabled,
-	&ux_blind_signing_disabled_go_back
-);
-
 UX_STEP_VALID(
     ux_blind_signing_enabled,
     bnnn,
@@ -200,7 +214,31 @@ UX_STEP_VALID(
 
 	});
 UX_STEP_VALID(
-    ux_blind_signing_enabled_go_back,
+    ux_prehashed_signing_disabled,
+    bnnn,
+    io_seproxyhal_touch_enable_prehashed_signing(NULL),
+    {
+        "Prehashed Msgs",
+        "Sign host digests,",
+		"can authorize txs",
+		"NOT Enabled"
+
+	});
+
+UX_STEP_VALID(
+    ux_prehashed_signing_enabled,
+    bnnn,
+    io_seproxyhal_touch_disable_prehashed_signing(NULL),
+    {
+        "Prehashed Msgs",
+        "Sign host digests,",
+		"can authorize txs",
+		"Enabled"
+
+	});
+
+UX_STEP_VALID(
+    ux_settings_go_back,
     bb,
     io_seproxyhal_touch_to_idle(NULL),
     {	
@@ -208,10 +246,8 @@ UX_STEP_VALID(
         "",
 	});
 
-UX_FLOW(ux_settings_blind_signing_enabled_flow,
-	&ux_blind_signing_enabled,
-	&ux_blind_signing_enabled_go_back
-);
+/** the settings flow, built by settings_flow_init with the step of each setting as it is. */
+static const ux_flow_step_t * ux_settings_flow[2 + 1 + 1];
 
 /**
 	Blind Signing UI
@@ -257,6 +293,143 @@ UX_FLOW(ux_blind_signing_flow,
 	&ux_blind_signing_flow_step_4
 );
 
+UX_STEP_NOCB(
+    ux_blind_signing_prehashed_warning_step,
+    pnn,
+    {
+        &C_icon_warning,
+        "Can authorize",
+        "transactions"
+	});
+
+UX_STEP_NOCB(
+    ux_blind_signing_digest_step,
+    bnn,
+    {
+        tx_desc[0][0],
+        tx_desc[0][1],
+        tx_desc[0][2]
+	});
+
+UX_FLOW(ux_blind_signing_digest_flow,
+    &ux_blind_signing_flow_step_1,
+	&ux_blind_signing_prehashed_warning_step,
+	&ux_blind_signing_digest_step,
+	&ux_blind_signing_flow_step_3,
+	&ux_blind_signing_flow_step_4
+);
+
+/**
+	Sign Data UI
+*/
+
+UX_STEP_NOCB(
+    ux_sign_data_flow_1_step,
+    nn,
+    {
+        "Review",
+        "Data"
+	});
+UX_STEP_NOCB(
+    ux_sign_data_flow_2_step,
+    bn,
+    {
+        tx_desc[0][0],
+        tx_desc[0][1],
+	});
+UX_STEP_NOCB(
+    ux_sign_data_flow_3_step,
+    bnn,
+    {
+        tx_desc[1][0],
+        tx_desc[1][1],
+        tx_desc[1][2]
+	});
+UX_STEP_NOCB(
+    ux_sign_data_flow_4_step,
+    bnn,
+    {
+        tx_desc[2][0],
+        tx_desc[2][1],
+        tx_desc[2][2]
+	});
+UX_STEP_NOCB(
+    ux_sign_data_flow_5_step,
+    bnn,
+    {
+        tx_desc[3][0],
+        tx_desc[3][1],
+        tx_desc[3][2]
+	});
+UX_STEP_VALID(
+    ux_sign_data_flow_6_step,
+    nn,
+    io_seproxyhal_touch_approve(NULL),
+    {
+        "Sign",
+        "Data"
+	});
+UX_STEP_VALID(
+    ux_sign_data_flow_7_step,
+    nn,
+    io_seproxyhal_touch_deny(NULL),
+    {
+        "Reject",
+        "Data"
+	});
+
+/** the size step, then a step for each key the host picked, one per tx_desc screen. */
+static const ux_flow_step_t * const ux_sign_data_desc_steps[] = {
+	&ux_sign_data_flow_2_step,
+	&ux_sign_data_flow_3_step,
+	&ux_sign_data_flow_4_step,
+	&ux_sign_data_flow_5_step
+};
+
+/** the sign data flow, built by ui_top_sign_data with only the screens max_scr_ix has, as the Nano S pager shows. */
+static const ux_flow_step_t * ux_sign_data_flow[1 + (sizeof(ux_sign_data_desc_steps) / sizeof(ux_sign_data_desc_steps[0])) + 2 + 1];
+
+/**
+	Export Account Key UI
+*/
+
+UX_STEP_NOCB(
+    ux_export_account_key_flow_1_step,
+    nn,
+    {
+        "Export",
+        "Account Key"
+	});
+UX_STEP_NOCB(
+    ux_export_account_key_flow_2_step,
+    bn,
+    {
+        tx_desc[0][0],
+        tx_desc[0][1],
+	});
+UX_STEP_VALID(
+    ux_export_account_key_flow_3_step,
+    nn,
+    io_seproxyhal_touch_approve_account_key(NULL),
+    {
+        "Approve",
+        "Export"
+	});
+UX_STEP_VALID(
+    ux_export_account_key_flow_4_step,
+    nn,
+    io_seproxyhal_touch_deny(NULL),
+    {
+        "Reject",
+        "Export"
+	});
+UX_FLOW(ux_export_account_key_flow,
+        &ux_export_account_key_flow_1_step,
+        &ux_export_account_key_flow_2_step,
+        &ux_export_account_key_flow_3_step,
+        &ux_export_account_key_flow_4_step
+        );
+
 /**
 	Confirm Transaction UI
 */
@@ -318,15 +491,25 @@ UX_STEP_VALID(
         "Reject",
         "Transaction"
 	});
-UX_FLOW(ux_confirm_single_flow,
-        &ux_confirm_single_flow_1_step,
-        &ux_confirm_single_flow_2_step,
-        &ux_confirm_single_flow_3_step,
-        &ux_confirm_single_flow_4_step,
-        &ux_confirm_single_flow_5_step,
-        &ux_confirm_single_flow_6_step,
-        &ux_confirm_single_flow_7_step
-        );
+UX_STEP_NOCB(
+    ux_confirm_single_flow_metagraph_step,
+    bn,
+    {
+        tx_desc[4][0],
+        tx_desc[4][1],
+	});
+
+/** a step per tx_desc screen, the fifth is the metagraph of a token transfer. */
+static const ux_flow_step_t * const ux_confirm_single_desc_steps[] = {
+	&ux_confirm_single_flow_2_step,
+	&ux_confirm_single_flow_3_step,
+	&ux_confirm_single_flow_4_step,
+	&ux_confirm_single_flow_5_step,
+	&ux_confirm_single_flow_metagraph_step
+};
+
+/** the confirm flow, built by ui_top_sign with only the screens max_scr_ix has, as the Nano S pager shows. */
+static const ux_flow_step_t * ux_confirm_single_flow[1 + (sizeof(ux_confirm_single_desc_steps) / sizeof(ux_confirm_single_desc_steps[0])) + 2 + 1];
 
 UX_STEP_NOCB(
     ux_display_public_flow_step,
@@ -389,7 +572,7 @@ UX_STEP_VALID(
 UX_STEP_VALID(
     ux_idle_flow_4_step,
     bn,
-    os_sched_exit(-1),
+    io_seproxyhal_touch_exit(NULL),
     {
         // &C_icon_dashboard,
         "Quit",
@@ -566,6 +749,92 @@ static unsigned int bagl_ui_blind_signing_enabled_nanos_button(unsigned int butt
 	return 0;
 }
 
+/** UI struct for the "Prehashed messages" setting screen while it is off, Nano S. */
+static const bagl_element_t bagl_ui_prehashed_signing_disabled_nanos[] = {
+// { {type, userid, x, y, width, height, stroke, radius, fill, fgcolor, bgcolor, font_id, icon_id},
+// text, touch_area_brim, overfgcolor, overbgcolor, tap, out, over,
+// },
+	{       {       BAGL_RECTANGLE, 0x00, 0, 0, 128, 32, 0, 0, BAGL_FILL, 0x000000, 0xFFFFFF, 0, 0 }, NULL},
+	/* top left bar */
+	{       {       BAGL_RECTANGLE, 0x00, 3, 1, 12, 2, 0, 0, BAGL_FILL, 0xFFFFFF, 0x000000, 0, 0 }, NULL},
+	/* top right bar */
+	{       {       BAGL_RECTANGLE, 0x00, 113, 1, 12, 2, 0, 0, BAGL_FILL, 0xFFFFFF, 0x000000, 0, 0 }, NULL},
+	/* Line 1 Text */
+	{       {       BAGL_LABELINE, 0x02, 0, 15, 128, 11, 0, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, "Prehashed Msgs"},
+	/* Line 2 Text */
+	{       {       BAGL_LABELINE, 0x02, 0, 26, 128, 11, 0, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, "Not Enabled"},
+	/* left icon is up arrow  */
+	{       {       BAGL_ICON, 0x00, 3, 12, 7, 7, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_UP }, NULL},
+	/* right icon is down arrow */
+	{       {       BAGL_ICON, 0x00, 117, 13, 8, 6, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_DOWN }, NULL},
+/* */
+};
+
+/**
+ * buttons for the "Prehashed messages" setting screen
+ *
+ * up on Left button, down on right button, toggle on both buttons.
+ */
+static unsigned int bagl_ui_prehashed_signing_disabled_nanos_button(unsigned int button_mask, unsigned int button_mask_counter) {
+	UNUSED(button_mask_counter);
+
+	switch (button_mask) {
+	case BUTTON_EVT_RELEASED | BUTTON_LEFT | BUTTON_RIGHT:
+		io_seproxyhal_touch_enable_prehashed_signing(NULL);
+		break;
+	case BUTTON_EVT_RELEASED | BUTTON_LEFT:
+		tx_desc_up(NULL);
+		break;
+	case BUTTON_EVT_RELEASED | BUTTON_RIGHT:
+		tx_desc_dn(NULL);
+		break;
+	}
+	return 0;
+}
+
+/** UI struct for the "Prehashed messages" setting screen while it is on, Nano S. */
+static const bagl_element_t bagl_ui_prehashed_signing_enabled_nanos[] = {
+// { {type, userid, x, y, width, height, stroke, radius, fill, fgcolor, bgcolor, font_id, icon_id},
+// text, touch_area_brim, overfgcolor, overbgcolor, tap, out, over,
+// },
+	{       {       BAGL_RECTANGLE, 0x00, 0, 0, 128, 32, 0, 0, BAGL_FILL, 0x000000, 0xFFFFFF, 0, 0 }, NULL},
+	/* top left bar */
+	{       {       BAGL_RECTANGLE, 0x00, 3, 1, 12, 2, 0, 0, BAGL_FILL, 0xFFFFFF, 0x000000, 0, 0 }, NULL},
+	/* top right bar */
+	{       {       BAGL_RECTANGLE, 0x00, 113, 1, 12, 2, 0, 0, BAGL_FILL, 0xFFFFFF, 0x000000, 0, 0 }, NULL},
+	/* Line 1 Text */
+	{       {       BAGL_LABELINE, 0x02, 0, 15, 128, 11, 0, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, "Prehashed Msgs"},
+	/* Line 2 Text */
+	{       {       BAGL_LABELINE, 0x02, 0, 26, 128, 11, 0, 0, 0, 0xFFFFFF, 0x000000, TX_DESC_FONT, 0 }, "Enabled"},
+	/* left icon is up arrow  */
+	{       {       BAGL_ICON, 0x00, 3, 12, 7, 7, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_UP }, NULL},
+	/* right icon is down arrow */
+	{       {       BAGL_ICON, 0x00, 117, 13, 8, 6, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_DOWN }, NULL},
+/* */
+};
+
+/**
+ * buttons for the "Prehashed messages" setting screen
+ *
+ * up on Left button, down on right button, toggle on both buttons.
+ */
+static unsigned int bagl_ui_prehashed_signing_enabled_nanos_button(unsigned int button_mask, unsigned int button_mask_counter) {
+	UNUSED(button_mask_counter);
+
+	switch (button_mask) {
+	case BUTTON_EVT_RELEASED | BUTTON_LEFT | BUTTON_RIGHT:
+		io_seproxyhal_touch_disable_prehashed_signing(NULL);
+		break;
+	case BUTTON_EVT_RELEASED | BUTTON_LEFT:
+		tx_desc_up(NULL);
+		break;
+	case BUTTON_EVT_RELEASED | BUTTON_RIGHT:
+		tx_desc_dn(NULL);
+		break;
+	}
+	return 0;
+}
+
 /** UI struct for the bottom "Sign Transaction" screen, Nano S. */
 static const bagl_element_t bagl_ui_settings_go_back_nanos[] = {
 // { {type, userid, x, y, width, height, stroke, radius, fill, fgcolor, bgcolor, font_id, icon_id},
@@ -609,6 +878,13 @@ static unsigned int bagl_ui_settings_go_back_nanos_button(unsigned int button_ma
 ///////////////////////////////////////
 
 
+/** what the top, sign and deny screens of the pager call what is reviewed on it, a transaction, structured data or an account key. */
+static char pager_review_label[MAX_TX_TEXT_WIDTH];
+static char pager_sign_label[MAX_TX_TEXT_WIDTH];
+static char pager_deny_label[MAX_TX_TEXT_WIDTH];
+/** what the pager's sign screen approves, so an export is only sent by the export's own review. */
+static const bagl_element_t * (*pager_approve)(const bagl_element_t *e);
+
 /** UI struct for the top "Sign Transaction" screen, Nano S. */
 static const bagl_element_t bagl_ui_top_sign_nanos[] = {
 // { {type, userid, x, y, width, height, stroke, radius, fill, fgcolor, bgcolor, font_id, icon_id},
@@ -620,7 +896,7 @@ static const bagl_element_t bagl_ui_top_sign_nanos[] = {
 	/* top right bar */
 //	{       {       BAGL_RECTANGLE, 0x00, 113, 1, 12, 2, 0, 0, BAGL_FILL, 0xFFFFFF, 0x000000, 0, 0 }, NULL},
 	/* center text */
-	{       {       BAGL_LABELINE, 0x02, 0, 20, 128, 11, 0, 0, 0, 0xFFFFFF, 0x000000, DEFAULT_FONT, 0 }, "Review Tx"},
+	{       {       BAGL_LABELINE, 0x02, 0, 20, 128, 11, 0, 0, 0, 0xFFFFFF, 0x000000, DEFAULT_FONT, 0 }, pager_review_label},
 	/* left icon is up arrow  */
 	{       {       BAGL_ICON, 0x00, 3, 12, 7, 7, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_UP }, NULL},
 	/* right icon is down arrow */
@@ -665,7 +941,7 @@ static const bagl_element_t bagl_ui_sign_nanos[] = {
 	/* top right bar */
 	{       {       BAGL_RECTANGLE, 0x00, 113, 1, 12, 2, 0, 0, BAGL_FILL, 0xFFFFFF, 0x000000, 0, 0 }, NULL},
 	/* center text */
-	{       {       BAGL_LABELINE, 0x02, 0, 20, 128, 11, 0, 0, 0, 0xFFFFFF, 0x000000, DEFAULT_FONT, 0 }, "Sign Tx"},
+	{       {       BAGL_LABELINE, 0x02, 0, 20, 128, 11, 0, 0, 0, 0xFFFFFF, 0x000000, DEFAULT_FONT, 0 }, pager_sign_label},
 	/* left icon is up arrow  */
 	{       {       BAGL_ICON, 0x00, 3, 12, 7, 7, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_UP }, NULL},
 	/* right icon is down arrow */
@@ -683,7 +959,7 @@ static unsigned int bagl_ui_sign_nanos_button(unsigned int button_mask, unsigned
 
 	switch (button_mask) {
 	case BUTTON_EVT_RELEASED | BUTTON_LEFT | BUTTON_RIGHT:
-		io_seproxyhal_touch_approve(NULL);
+		pager_approve(NULL);
 		break;
 
 	case BUTTON_EVT_RELEASED | BUTTON_RIGHT:
@@ -708,7 +984,7 @@ static const bagl_element_t bagl_ui_deny_nanos[] = {
 	/* top right bar */
 	{       {       BAGL_RECTANGLE, 0x00, 113, 1, 12, 2, 0, 0, BAGL_FILL, 0xFFFFFF, 0x000000, 0, 0 }, NULL},
 	/* center text */
-	{       {       BAGL_LABELINE, 0x02, 0, 20, 128, 11, 0, 0, 0, 0xFFFFFF, 0x000000, DEFAULT_FONT, 0 }, "Deny Tx"},
+	{       {       BAGL_LABELINE, 0x02, 0, 20, 128, 11, 0, 0, 0, 0xFFFFFF, 0x000000, DEFAULT_FONT, 0 }, pager_deny_label},
 	/* left icon is up arrow  */
 	{       {       BAGL_ICON, 0x00, 3, 12, 7, 7, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_UP }, NULL},
 	{       {       BAGL_ICON, 0x00, 117, 13, 7, 7, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_DOWN }, NULL},
@@ -836,6 +1112,23 @@ static const bagl_element_t bagl_ui_blind_signing_warning_nanos[] = {
 /* */
 };
 
+/** UI struct for the "Blind signing warning" screen of a prehashed message, Nano S. */
+static const bagl_element_t bagl_ui_blind_signing_prehashed_warning_nanos[] = {
+// { {type, userid, x, y, width, height, stroke, radius, fill, fgcolor, bgcolor, font_id, icon_id},
+// text, touch_area_brim, overfgcolor, overbgcolor, tap, out, over,
+// },
+	{       {       BAGL_RECTANGLE, 0x00, 0, 0, 128, 32, 0, 0, BAGL_FILL, 0x000000, 0xFFFFFF, 0, 0 }, NULL},
+	/* First line of warning message  */
+	{       {       BAGL_LABELINE, 0x02, 10, 10, 108, 11, 0x80 | 10, 0, 0, 0xFFFFFF, 0x000000, DEFAULT_FONT, 0 }, "Warning!"},
+	/* Second line of warning message  */
+	{       {       BAGL_LABELINE, 0x02, 10, 26, 108, 11, 0, 0, 0, 0xFFFFFF, 0x000000, DEFAULT_FONT, 0 }, "Can authorize txs"},
+	/* left icon is up arrow  */
+	{       {       BAGL_ICON, 0x00, 3, 12, 7, 7, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_UP }, NULL},
+	/* right icon is down arrow */
+	{       {       BAGL_ICON, 0x00, 117, 13, 8, 6, 0, 0, 0, 0xFFFFFF, 0x000000, 0, BAGL_GLYPH_ICON_DOWN }, NULL},
+/* */
+};
+
 /**
  * buttons for the "Blind signing warning" screen
  *
@@ -856,6 +1149,11 @@ static unsigned int bagl_ui_blind_signing_warning_nanos_button(unsigned int butt
 	return 0;
 }
 
+/** buttons for the "Blind signing warning" screen of a prehashed message, as the other one. */
+static unsigned int bagl_ui_blind_signing_prehashed_warning_nanos_button(unsigned int button_mask, unsigned int button_mask_counter) {
+	return bagl_ui_blind_signing_warning_nanos_button(button_mask, button_mask_counter);
+}
+
 /** UI struct for the "Sign Message" screen, Nano S. */
 static const bagl_element_t bagl_ui_blind_signing_accept_message_nanos[] = {
 // { {type, userid, x, y, width, height, stroke, radius, fill, fgcolor, bgcolor, font_id, icon_id},
@@ -979,14 +1277,6 @@ static unsigned int bagl_ui_blind_singing_must_enable_message_nanos_button(unsig
 	return 0;
 }
 
-/** if the user wants to exit go back to the app dashboard. */
-static const bagl_element_t *io_seproxyhal_touch_exit(const bagl_element_t *e) {
-	UNUSED(e);
-	// Go back to the dashboard
-	os_sched_exit(0);
-	return NULL;                     // do not redraw the widget
-}
-
 /** copy the current row of the tx_desc buffer into curr_tx_desc to display on the screen */
 static void copy_tx_desc(void) {
 	memmove(curr_tx_desc, tx_desc[curr_scr_ix], CURR_TX_DESC_LEN);
@@ -1006,7 +1296,7 @@ static const bagl_element_t * tx_desc_up(const bagl_element_t *e) {
 		break;
 	case UI_TX_DESC_1:
 		if (curr_scr_ix == 0) {
-			ui_top_sign();
+			ui_top_review();
 		} else {
 			curr_scr_ix--;
 			copy_tx_desc();
@@ -1027,20 +1317,30 @@ static const bagl_element_t * tx_desc_up(const bagl_element_t *e) {
 	case UI_BLIND_SIGNING_WARNING:
 		ui_top_blind_signing();
 		break;
-	case UI_BLIND_SIGNING_ACCEPT:
+	case UI_BLIND_SIGNING_DIGEST:
 		ui_blind_signing_warning();
 		break;
+	case UI_BLIND_SIGNING_ACCEPT:
+		if (operation == OP_BLIND_SIGN_PREHASHED) {
+			ui_blind_signing_digest();
+		} else {
+			ui_blind_signing_warning();
+		}
+		break;
 	case UI_BLIND_SIGNING_REJECT:
 		ui_blind_signing_accept();
 		break;
 	case UI_IDLE_SETTINGS:
 		ui_idle();
 		break;
-	case UI_BLIND_SIGNING_SETTING_GO_BACK:
+	case UI_PREHASHED_SIGNING_SETTINGS:
 		ui_blind_signing_settings();
 		break;
+	case UI_BLIND_SIGNING_SETTING_GO_BACK:
+		ui_prehashed_signing_settings();
+		break;
 	default:
-		hashTainted = 1;
+		operation = OP_NONE;
 		THROW(0x6D02);
 		break;
 	}
@@ -1074,12 +1374,19 @@ static const bagl_element_t * tx_desc_dn(const bagl_element_t *e) {
 		ui_deny();
 		break;
 	case UI_DENY:
-		ui_top_sign();
+		ui_top_review();
 		break;
 	case UI_TOP_BLIND_SIGNING:
 		ui_blind_signing_warning();
 		break;
 	case UI_BLIND_SIGNING_WARNING:
+		if (operation == OP_BLIND_SIGN_PREHASHED) {
+			ui_blind_signing_digest();
+		} else {
+			ui_blind_signing_accept();
+		}
+		break;
+	case UI_BLIND_SIGNING_DIGEST:
 		ui_blind_signing_accept();
 		break;
 	case UI_BLIND_SIGNING_ACCEPT:
@@ -1089,10 +1396,13 @@ static const bagl_element_t * tx_desc_dn(const bagl_element_t *e) {
 		ui_top_blind_signing();
 		break;
 	case UI_BLIND_SIGNING_SETTINGS:
+		ui_prehashed_signing_settings();
+		break;
+	case UI_PREHASHED_SIGNING_SETTINGS:
 		ui_blind_settings_go_back();
 		break;
 	default:
-		hashTainted = 1;
+		operation = OP_NONE;
 		THROW(0x6D01);
 		break;
 	}
@@ -1100,76 +1410,47 @@ static const bagl_element_t * tx_desc_dn(const bagl_element_t *e) {
 }
 #endif
 
-unsigned int utf8Length(unsigned char * buffer, unsigned int value) {
-	unsigned int utfLengthAsHex = 0;
-	if (value >> 6 == 0) {
-		utfLengthAsHex = 1;
-		buffer[0] = (value | 0x80);         // Set bit 8.
-	} else if (value >> 13 == 0) {
-		utfLengthAsHex = 2;
-		buffer[0] = (value | 0x40 | 0x80);         // Set bit 7 and 8.
-		buffer[1] = (value >> 6);
-	} else if (value >> 20 == 0) {
-		utfLengthAsHex = 3;
-		buffer[0] = (value | 0x40 | 0x80);         // Set bit 7 and 8.
-		buffer[1] = ((value >> 6) | 0x80);         // Set bit 8.
-		buffer[2] = (value >> 13);
-	} else if (value >> 27 == 0) {
-		utfLengthAsHex = 4;
-		buffer[0] = (value | 0x40 | 0x80);         // Set bit 7 and 8.
-		buffer[1] = ((value >> 6) | 0x80);         // Set bit 8.
-		buffer[2] = ((value >> 13) | 0x80);         // Set bit 8.
-		buffer[3] = (value >> 20);
-	} else {
-		utfLengthAsHex = 5;
-		buffer[0] = (value | 0x40 | 0x80);         // Set bit 7 and 8.
-		buffer[1] = ((value >> 6) | 0x80);         // Set bit 8.
-		buffer[2] = ((value >> 13) | 0x80);         // Set bit 8.
-		buffer[3] = ((value >> 20) | 0x80);         // Set bit 8.
-		buffer[4] = (value >> 27);
+/** signs msg_hash with the bip44 path kept in raw_tx, and returns the signature length. */
+static unsigned int sign_msg_hash(void) {
+	const unsigned char * bip44_in = raw_tx;
+	unsigned int bip44_path[BIP44_PATH_LEN];
+	uint32_t i;
+	for (i = 0; i < BIP44_PATH_LEN; i++) {
+		bip44_path[i] = (bip44_in[0] << 24) | (bip44_in[1] << 16) | (bip44_in[2] << 8) | (bip44_in[3]);
+		bip44_in += 4;
 	}
-	return utfLengthAsHex;
+
+	cx_ecfp_private_key_t privateKey;
+	unsigned char privateKeyData[32];
+	derive_node(bip44_path, BIP44_PATH_LEN, privateKeyData, NULL);
+	cx_ecdsa_init_private_key(CX_CURVE_256K1, privateKeyData, 32, &privateKey);
+
+	unsigned int siglen = cx_ecdsa_sign(&privateKey, CX_RND_RFC6979, CX_SHA256, msg_hash, CX_SHA512_SIZE, G_io_apdu_buffer, SIGNATURE_LEN, NULL);
+
+	cx_ecdsa_init_private_key(CX_CURVE_256K1, NULL, 0, &privateKey);
+	memset(privateKeyData, 0x00, sizeof(privateKeyData));
+	memset(msg_hash, 0x00, sizeof(msg_hash));
+	return siglen;
 }
 
 /** Sign the message. The UI is only displayed when all of the message has been sent over for signing. */
 const bagl_element_t*io_seproxyhal_touch_approve2(const bagl_element_t *e) {
 	UNUSED(e);
 
-	unsigned int tx = 0;
-
-	if (G_io_apdu_buffer[2] == P1_LAST) {				
-		// Hash the message
-		uint8_t hash512Digest[CX_SHA512_SIZE];
-		cx_hash_sha512(raw_tx, raw_tx_ix-BIP44_BYTE_LENGTH, hash512Digest, CX_SHA512_SIZE);
-
-		/** BIP44 path, used to derive the private key from the mnemonic 
-		 * 	by calling os_perso_derive_node_bip32. BIP44 path is appended to every message */
-		unsigned char * bip44_in = &(raw_tx[raw_tx_ix]) - BIP44_BYTE_LENGTH;
-		unsigned int bip44_path[BIP44_PATH_LEN];
-		uint32_t i;
-		for (i = 0; i < BIP44_PATH_LEN; i++) {
-			bip44_path[i] = (bip44_in[0] << 24) | (bip44_in[1] << 16) | (bip44_in[2] << 8) | (bip44_in[3]);
-			bip44_in += 4;
-		}
-
-		// Retreive the private key
-		cx_ecfp_private_key_t privateKey;
-    	unsigned char privateKeyData[32];
-    	memset(privateKeyData, 0, sizeof(privateKeyData));
-    	os_perso_derive_node_bip32(CX_CURVE_256K1, bip44_path, BIP44_PATH_LEN, privateKeyData, NULL);
-    	cx_ecdsa_init_private_key(CX_CURVE_256K1, privateKeyData, 32, &privateKey);
+	// the review is stale once what it was for was dropped by a later instruction, that instruction has been answered.
+	if ((G_io_apdu_buffer[2] == P1_LAST) && (operation != OP_BLIND_SIGN) && (operation != OP_BLIND_SIGN_PREHASHED)) {
+		ui_idle();
+		return 0;
+	}
 
-		// Sign the message
-    	int siglen = cx_ecdsa_sign(&privateKey, CX_RND_RFC6979, CX_SHA256, hash512Digest, CX_SHA512_SIZE, G_io_apdu_buffer, SIGNATURE_LEN, NULL);
+	unsigned int tx = 0;
 
-		// Clear private key data
-		cx_ecdsa_init_private_key(CX_CURVE_256K1, NULL, 0, &privateKey);
-		memset(privateKeyData, 0x00, sizeof(privateKeyData));
-		
-		hashTainted = 1; // reset for next packet
+	if (G_io_apdu_buffer[2] == P1_LAST) {
+		// the message was hashed as it came in, only the bip44 path after it was kept.
+		tx = sign_msg_hash();
 
-		// Move the signature to the ADPU buffer
-		tx=siglen;
+		operation = OP_NONE;
+		raw_tx_ix = 0;
 	}
 
 	// Append success code
@@ -1184,14 +1465,73 @@ const bagl_element_t*io_seproxyhal_touch_approve2(const bagl_element_t *e) {
 }
 
 
+/** text sink that appends the letters to the response in G_io_apdu_buffer, the context is the response length. */
+static void apdu_text_sink(void * context, const char * text, const unsigned int text_len) {
+	unsigned int * tx = context;
+	memmove(G_io_apdu_buffer + *tx, text, text_len);
+	*tx += text_len;
+}
+
+/** sends back the public key and chain code of account_key_path, once the user approved the export. */
+static const bagl_element_t * io_seproxyhal_touch_approve_account_key(const bagl_element_t *e) {
+	UNUSED(e);
+
+	// the export is stale once a later instruction dropped it, that instruction has been answered.
+	if (operation != OP_EXPORT_ACCOUNT_KEY) {
+		ui_idle();
+		return 0;
+	}
+
+	cx_ecfp_public_key_t publicKey;
+	cx_ecfp_private_key_t privateKey;
+	unsigned char privateKeyData[32];
+	unsigned char chainCode[CHAIN_CODE_LEN];
+
+	derive_node(account_key_path, BIP44_ACCOUNT_PATH_LEN, privateKeyData, chainCode);
+	cx_ecdsa_init_private_key(CX_CURVE_256K1, privateKeyData, 32, &privateKey);
+	cx_ecdsa_init_public_key(CX_CURVE_256K1, NULL, 0, &publicKey);
+	cx_ecfp_generate_pair(CX_CURVE_256K1, &publicKey, &privateKey, 1);
+
+	cx_ecdsa_init_private_key(CX_CURVE_256K1, NULL, 0, &privateKey);
+	memset(privateKeyData, 0x00, sizeof(privateKeyData));
+
+	unsigned int tx = 0;
+	memmove(G_io_apdu_buffer + tx, publicKey.W, PUBLIC_KEY_LEN);
+	tx += PUBLIC_KEY_LEN;
+	memmove(G_io_apdu_buffer + tx, chainCode, CHAIN_CODE_LEN);
+	tx += CHAIN_CODE_LEN;
+
+	operation = OP_NONE;
+	clear_tx_desc();
+	G_io_apdu_buffer[tx++] = 0x90;
+	G_io_apdu_buffer[tx++] = 0x00;
+	// Send back the response, do not restart the event loop
+	io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, tx);
+	// Display back the original UX
+	ui_idle();
+	return 0;                     // do not redraw the widget
+}
+
 /** processes the transaction approval. the UI is only displayed when all of the TX has been sent over for signing. */
 const bagl_element_t*io_seproxyhal_touch_approve(const bagl_element_t *e) {
 	UNUSED(e);
 
+	// the review is stale once what it was for was dropped by a later instruction, that instruction has been answered.
+	if ((G_io_apdu_buffer[2] == P1_LAST) && (operation != OP_SIGN_TX) && (operation != OP_SIGN_DATA)) {
+		ui_idle();
+		return 0;
+	}
+
   unsigned int tx = 0;
-	if (G_io_apdu_buffer[2] == P1_LAST) {
-		unsigned int raw_tx_len_except_bip44 = raw_tx_len - BIP44_BYTE_LENGTH;
-		unsigned char * bip44_in = raw_tx + raw_tx_len_except_bip44;
+	if ((G_io_apdu_buffer[2] == P1_LAST) && (operation == OP_SIGN_DATA)) {
+		tx = sign_msg_hash();
+
+		operation = OP_NONE;
+		clear_tx_desc();
+		raw_tx_ix = 0;
+		raw_tx_len = 0;
+	} else if (G_io_apdu_buffer[2] == P1_LAST) {
+		const unsigned char * bip44_in = tx_bip44_path();
 
 		/** BIP44 path, used to derive the private key from the mnemonic by calling os_perso_derive_node_bip32. */
 		unsigned int bip44_path[BIP44_PATH_LEN];
@@ -1201,35 +1541,14 @@ const bagl_element_t*io_seproxyhal_touch_approve(const bagl_element_t *e) {
 			bip44_in += 4;
 		}
 
-		// Hash is finalized, send back the signature
-		unsigned char result256[CX_SHA256_SIZE];
-		memset(result256, 0x00, sizeof(result256));
-
-		cx_sha256_t hash_context_256;
-		cx_hash_t * hash_ptr_256 = (cx_hash_t *)&hash_context_256;
-		cx_sha256_init(&hash_context_256);
-
-		unsigned char utfLengthAsHex[6];
-		unsigned int utfLengthAsHexLen = utf8Length(utfLengthAsHex,hash_data_ix+1);
-		cx_hash(hash_ptr_256, 0, KRYO_PREFIX, sizeof(KRYO_PREFIX), result256, sizeof(result256));
-		cx_hash(hash_ptr_256, 0, utfLengthAsHex, utfLengthAsHexLen, result256, sizeof(result256));
-		cx_hash(hash_ptr_256, CX_LAST, hash_data, hash_data_ix, result256, sizeof(result256));
-
+		// the sha256 of the serialization was computed by calc_hash, when the last chunk came in.
 		//encode the result and hash again.
-		unsigned char result256hex[CX_SHA256_SIZE * 2];
-		memset(result256hex, 0x00, sizeof(result256hex));
-		unsigned int result256hex_ix = 0;
-		for(unsigned int ix = 0; ix < CX_SHA256_SIZE * 2; ix++) {
-			unsigned char c = result256[ix];
-			unsigned int i0 = (c>>4)&0xF;
-			unsigned int i1 = c&0xF;
-			result256hex[result256hex_ix++] = BASE_16_ALPHABET[i0];
-			result256hex[result256hex_ix++] = BASE_16_ALPHABET[i1];
-		}
+		char result256hex[CX_SHA256_SIZE * 2];
+		to_hex_lower(result256hex, tx_hash, sizeof(result256hex));
 
 		unsigned char result512[CX_SHA512_SIZE];
 		memset(result512, 0x00, sizeof(result512));
-		cx_hash_sha512(result256hex, sizeof(result256hex), result512, sizeof(result512));
+		cx_hash_sha512((unsigned char *)result256hex, sizeof(result256hex), result512, sizeof(result512));
 
     unsigned char result[32];
     memset(result, 0x00, sizeof(result));
@@ -1242,7 +1561,7 @@ const bagl_element_t*io_seproxyhal_touch_approve(const bagl_element_t *e) {
 
     cx_ecfp_private_key_t privateKey;
     unsigned char privateKeyData[32];
-    os_perso_derive_node_bip32(CX_CURVE_256K1, bip44_path, BIP44_PATH_LEN, privateKeyData, NULL);
+    derive_node(bip44_path, BIP44_PATH_LEN, privateKeyData, NULL);
     cx_ecdsa_init_private_key(CX_CURVE_256K1, privateKeyData, 32, &privateKey);
 
     tx = cx_ecdsa_sign((void*) &privateKey, CX_RND_RFC6979, CX_SHA256, result, sizeof(result), G_io_apdu_buffer, sizeof(G_io_apdu_buffer), NULL);
@@ -1251,29 +1570,29 @@ const bagl_element_t*io_seproxyhal_touch_approve(const bagl_element_t *e) {
 		memset(privateKeyData, 0x00, sizeof(privateKeyData));
 
 		// G_io_apdu_buffer[0] &= 0xF0; // discard the parity information
-		hashTainted = 1;
-		clear_tx_desc();
-		raw_tx_ix = 0;
-		raw_tx_len = 0;
 
 		// add hash to the response, so we can see where the bug is.
 		G_io_apdu_buffer[tx++] = 0xFF;
 		G_io_apdu_buffer[tx++] = 0xFF;
-		for (int ix = 0; ix < 32; ix++) {
-			G_io_apdu_buffer[tx++] = result256[ix];
+		for (int ix = 0; ix < CX_SHA256_SIZE; ix++) {
+			G_io_apdu_buffer[tx++] = tx_hash[ix];
 		}
 		G_io_apdu_buffer[tx++] = 0xFF;
 		G_io_apdu_buffer[tx++] = 0xFF;
 
-		for (unsigned int ix = 0; ix < sizeof(KRYO_PREFIX); ix++) {
-			G_io_apdu_buffer[tx++] = KRYO_PREFIX[ix];
-		}
-		for (unsigned int ix = 0; ix < utfLengthAsHexLen; ix++) {
-			G_io_apdu_buffer[tx++] = utfLengthAsHex[ix];
-		}
-		for (unsigned int ix = 0; ix < hash_data_ix; ix++) {
-			G_io_apdu_buffer[tx++] = hash_data[ix];
+		// the serialization is only echoed if it was kept, and fits in the response along with the status word.
+		unsigned char header[KRYO_HEADER_MAX_LEN];
+		unsigned int header_len = kryo_header(tx_schema, header, tx_text_len);
+		if (!tx_streamed && (tx + header_len + tx_text_len + 2 <= sizeof(G_io_apdu_buffer))) {
+			memmove(G_io_apdu_buffer + tx, header, header_len);
+			tx += header_len;
+			serialize_tx(apdu_text_sink, &tx);
 		}
+
+		operation = OP_NONE;
+		clear_tx_desc();
+		raw_tx_ix = 0;
+		raw_tx_len = 0;
 	}
 	G_io_apdu_buffer[tx++] = 0x90;
 	G_io_apdu_buffer[tx++] = 0x00;
@@ -1284,11 +1603,22 @@ const bagl_element_t*io_seproxyhal_touch_approve(const bagl_element_t *e) {
 	return 0;                     // do not redraw the widget
 }
 
+/** if the user wants to exit go back to the app dashboard. */
+static const bagl_element_t *io_seproxyhal_touch_exit(const bagl_element_t *e) {
+	UNUSED(e);
+	// the cached keys do not outlive the app.
+	key_cache_wipe();
+	derive_node_wipe();
+	// Go back to the dashboard
+	os_sched_exit(0);
+	return NULL;                     // do not redraw the widget
+}
+
 /** deny signing. */
 static const bagl_element_t *io_seproxyhal_touch_deny(const bagl_element_t *e) {
 	UNUSED(e);
 
-	hashTainted = 1;
+	operation = OP_NONE;
 	clear_tx_desc();
 	raw_tx_ix = 0;
 	raw_tx_len = 0;
@@ -1334,6 +1664,22 @@ static const bagl_element_t * io_seproxyhal_touch_disable_blind_signing(const ba
 	return 0;        
 }
 
+static const bagl_element_t * io_seproxyhal_touch_enable_prehashed_signing(const bagl_element_t *e) {
+
+	UNUSED(e);
+	prehashed_signing_enabled_bool = true;
+	ui_prehashed_signing_settings();
+	return 0;
+}
+
+static const bagl_element_t * io_seproxyhal_touch_disable_prehashed_signing(const bagl_element_t *e) {
+
+	UNUSED(e);
+	prehashed_signing_enabled_bool = false;
+	ui_prehashed_signing_settings();
+	return 0;
+}
+
 /////////////////////////////////////////////////
 // Idle UI for both TX signing and Blind Signing
 /////////////////////////////////////////////////
@@ -1382,21 +1728,91 @@ static void ui_sign(void) {
 }
 #endif
 
+#if defined(TARGET_NANOS)
+static void ui_top_review(void) {
+	uiState = UI_TOP_SIGN;
+	UX_DISPLAY(bagl_ui_top_sign_nanos, NULL);
+}
+
+/** labels the top, sign and deny screens of the pager, sets what its sign screen approves, and shows its top screen. */
+static void ui_review(const char * review, const char * sign, const char * deny, const bagl_element_t * (*approve)(const bagl_element_t *e)) {
+	snprintf(pager_review_label, sizeof(pager_review_label), "%s", review);
+	snprintf(pager_sign_label, sizeof(pager_sign_label), "%s", sign);
+	snprintf(pager_deny_label, sizeof(pager_deny_label), "%s", deny);
+	pager_approve = approve;
+	ui_top_review();
+}
+#endif
+
 /** show the top "Sign Transaction" screen. */
 void ui_top_sign(void) {
 	uiState = UI_TOP_SIGN;
 
 #if defined(TARGET_NANOS)
-	UX_DISPLAY(bagl_ui_top_sign_nanos, NULL);
+	ui_review("Review Tx", "Sign Tx", "Deny Tx", io_seproxyhal_touch_approve);
 #elif defined(TARGET_NANOX) || defined(TARGET_NANOS2)
 	// reserve a display stack slot if none yet
 	if(G_ux.stack_count == 0) {
 		ux_stack_push();
 	}
+	// the review step, a step per screen the selector filled, then accept and reject.
+	unsigned int step_ix = 0;
+	ux_confirm_single_flow[step_ix++] = &ux_confirm_single_flow_1_step;
+	for(unsigned int scr_ix = 0; (scr_ix < max_scr_ix) && (scr_ix < (sizeof(ux_confirm_single_desc_steps) / sizeof(ux_confirm_single_desc_steps[0]))); scr_ix++) {
+		ux_confirm_single_flow[step_ix++] = ux_confirm_single_desc_steps[scr_ix];
+	}
+	ux_confirm_single_flow[step_ix++] = &ux_confirm_single_flow_6_step;
+	ux_confirm_single_flow[step_ix++] = &ux_confirm_single_flow_7_step;
+	ux_confirm_single_flow[step_ix] = FLOW_END_STEP;
 	ux_flow_init(0, ux_confirm_single_flow, NULL);
 #endif // #if TARGET_ID
 }
 
+/** show the top "Sign Data" screen. */
+void ui_top_sign_data(void) {
+#if defined(TARGET_NANOS)
+	// the same pager as a transaction, through the size screen and a screen per picked key.
+	ui_review("Review Data", "Sign Data", "Deny Data", io_seproxyhal_touch_approve);
+#elif defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+	uiState = UI_TOP_SIGN;
+	// reserve a display stack slot if none yet
+	if(G_ux.stack_count == 0) {
+		ux_stack_push();
+	}
+	// the review step, a step per screen sign_data_begin filled, then sign and reject.
+	unsigned int step_ix = 0;
+	ux_sign_data_flow[step_ix++] = &ux_sign_data_flow_1_step;
+	for(unsigned int scr_ix = 0; scr_ix < max_scr_ix; scr_ix++) {
+		ux_sign_data_flow[step_ix++] = ux_sign_data_desc_steps[scr_ix];
+	}
+	ux_sign_data_flow[step_ix++] = &ux_sign_data_flow_6_step;
+	ux_sign_data_flow[step_ix++] = &ux_sign_data_flow_7_step;
+	ux_sign_data_flow[step_ix] = FLOW_END_STEP;
+	ux_flow_init(0, ux_sign_data_flow, NULL);
+#endif // #if TARGET_ID
+}
+
+/** show the top "Export Account Key" screen. */
+void ui_top_export_account_key(void) {
+	// one screen, with the account number, without its hardened flag.
+	clear_tx_desc();
+	memmove(tx_desc[0][0], TXT_ACCOUNT, sizeof(TXT_ACCOUNT));
+	format_fixed_point(account_key_path[BIP44_ACCOUNT_PATH_LEN - 1] & 0x7FFFFFFF, 0, false, false, tx_desc[0][1], MAX_TX_TEXT_WIDTH);
+	max_scr_ix = 1;
+	curr_scr_ix = 0;
+
+#if defined(TARGET_NANOS)
+	ui_review("Export Key", "Export", "Reject", io_seproxyhal_touch_approve_account_key);
+#elif defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+	uiState = UI_TOP_SIGN;
+	// reserve a display stack slot if none yet
+	if(G_ux.stack_count == 0) {
+		ux_stack_push();
+	}
+	ux_flow_init(0, ux_export_account_key_flow, NULL);
+#endif // #if TARGET_ID
+}
+
 #if defined(TARGET_NANOS)
 /** show the "deny" screen */
 static void ui_deny(void) {
@@ -1411,9 +1827,22 @@ static void ui_deny(void) {
 // Blind Signing
 ///////////////////////////////////////
 
+/** fills the first screen with the fingerprint of a prehashed message, the hex of each end of its digest. */
+static void digest_fingerprint_desc(void) {
+	clear_tx_desc();
+	memmove(tx_desc[0][0], TXT_DIGEST, sizeof(TXT_DIGEST));
+	to_hex_lower(tx_desc[0][1], msg_hash, DIGEST_FINGERPRINT_LEN * 2);
+	to_hex_lower(tx_desc[0][2], msg_hash + CX_SHA512_SIZE - DIGEST_FINGERPRINT_LEN, DIGEST_FINGERPRINT_LEN * 2);
+	tx_desc[0][1][DIGEST_FINGERPRINT_LEN * 2] = '\0';
+	tx_desc[0][2][DIGEST_FINGERPRINT_LEN * 2] = '\0';
+}
+
 /** show the top "Blind Signing" screen. */
 void ui_top_blind_signing(void) {
 	uiState = UI_TOP_BLIND_SIGNING;
+	if (operation == OP_BLIND_SIGN_PREHASHED) {
+		digest_fingerprint_desc();
+	}
 
 #if defined(TARGET_NANOS)
 	UX_DISPLAY(bagl_ui_top_blind_signing_nanos, NULL);
@@ -1422,7 +1851,7 @@ void ui_top_blind_signing(void) {
 	if(G_ux.stack_count == 0) {
 		ux_stack_push();
 	}
-	ux_flow_init(0, ux_blind_signing_flow, NULL);
+	ux_flow_init(0, (operation == OP_BLIND_SIGN_PREHASHED) ? ux_blind_signing_digest_flow : ux_blind_signing_flow, NULL);
 #endif // #if TARGET_ID
 }
 
@@ -1430,7 +1859,22 @@ void ui_top_blind_signing(void) {
 void ui_blind_signing_warning(void){
 	uiState = UI_BLIND_SIGNING_WARNING;
 	#if defined(TARGET_NANOS)
+	// a digest is signed the way a transaction is, so its warning says so.
+	if (operation == OP_BLIND_SIGN_PREHASHED) {
+		UX_DISPLAY(bagl_ui_blind_signing_prehashed_warning_nanos, NULL);
+	} else {
 		UX_DISPLAY(bagl_ui_blind_signing_warning_nanos, NULL);
+	}
+	#endif // #if TARGET_ID
+}
+
+void ui_blind_signing_digest(void){
+	uiState = UI_BLIND_SIGNING_DIGEST;
+	// the screen has two lines, so it shows the two ends of the digest without its title.
+	memmove(curr_tx_desc[0], tx_desc[0][1], MAX_TX_TEXT_WIDTH);
+	memmove(curr_tx_desc[1], tx_desc[0][2], MAX_TX_TEXT_WIDTH);
+	#if defined(TARGET_NANOS)
+		UX_DISPLAY(bagl_ui_tx_desc_nanos_1, NULL);
 	#endif // #if TARGET_ID
 }
 
@@ -1467,6 +1911,17 @@ void ui_blind_singing_must_enable_message(void) {
 #endif // #if TARGET_ID
 }
 
+#if defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+/** shows the settings flow from the step of setting start_ix. */
+static void settings_flow_init(unsigned int start_ix) {
+	ux_settings_flow[0] = blind_signing_enabled_bool ? &ux_blind_signing_enabled : &ux_blind_signing_disabled;
+	ux_settings_flow[1] = prehashed_signing_enabled_bool ? &ux_prehashed_signing_enabled : &ux_prehashed_signing_disabled;
+	ux_settings_flow[2] = &ux_settings_go_back;
+	ux_settings_flow[3] = FLOW_END_STEP;
+	ux_flow_init(0, ux_settings_flow, ux_settings_flow[start_ix]);
+}
+#endif
+
 void ui_blind_signing_settings(void) {
 	uiState = UI_BLIND_SIGNING_SETTINGS;
 
@@ -1481,11 +1936,25 @@ void ui_blind_signing_settings(void) {
 	if(G_ux.stack_count == 0) {
 		ux_stack_push();
 	}
-	if(blind_signing_enabled_bool){
-		ux_flow_init(0, ux_settings_blind_signing_enabled_flow, NULL);
+	settings_flow_init(0);
+#endif // #if TARGET_ID
+}
+
+static void ui_prehashed_signing_settings(void) {
+	uiState = UI_PREHASHED_SIGNING_SETTINGS;
+
+#if defined(TARGET_NANOS)
+	if(prehashed_signing_enabled_bool){
+		UX_DISPLAY(bagl_ui_prehashed_signing_enabled_nanos, NULL);
 	}else{
-		ux_flow_init(0, ux_settings_blind_signing_disabled_flow, NULL);
+		UX_DISPLAY(bagl_ui_prehashed_signing_disabled_nanos, NULL);
+	}
+#elif defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+	// reserve a display stack slot if none yet
+	if(G_ux.stack_count == 0) {
+		ux_stack_push();
 	}
+	settings_flow_init(1);
 #endif // #if TARGET_ID
 }
 
@@ -39,14 +39,23 @@ extern char timer_desc[MAX_TIMER_TEXT_WIDTH];
 /** for signing, indicates this is not the last part of the transaction, there are more parts coming. */
 #define P1_MORE 0x00
 
-/** length of BIP44 path */
-#define BIP44_PATH_LEN 5
+/** for signing, the transaction is kept in raw_tx until the last part, and hashed then. */
+#define P2_BUFFERED 0x00
 
-/** length of BIP44 path, in bytes */
-#define  BIP44_BYTE_LENGTH (BIP44_PATH_LEN * sizeof(unsigned int))
+/** for signing, flags the transaction is hashed as it streams in, and its first part starts with the 4 byte length of its kryo text. */
+#define P2_STREAMED 0x01
 
-/** size of the hash data. */
-#define HASH_DATA_SIZE 256
+/** for signing, flags a metagraph token transfer, the first part starts with the metagraph identifier, after the kryo text length if streamed. */
+#define P2_TOKEN 0x04
+
+/** for blind signing, flags the host sends the sha512 of the prefixed message, and the bip44 path, in one part, instead of the message. */
+#define P2_MSG_PREHASHED 0x01
+
+/** for getting public keys in a batch, asks for the DAG addresses instead of the public keys. */
+#define P2_ADDRESSES 0x01
+
+/** bytes of each end of a prehashed message's digest shown on its fingerprint screen. */
+#define DIGEST_FINGERPRINT_LEN 8
 
 /** max number of hex bytes that can be displayed (2 hex characters for 1 byte of data) */
 #define MAX_HEX_BUFFER_LEN (MAX_TX_TEXT_WIDTH / 2)
@@ -64,18 +73,30 @@ enum UI_STATE {
 	UI_PUBLIC_KEY_2, 
 	UI_TOP_BLIND_SIGNING, 
 	UI_BLIND_SIGNING_WARNING, 
+	UI_BLIND_SIGNING_DIGEST,
 	UI_BLIND_SIGNING_REJECT, 
 	UI_BLIND_SIGNING_ACCEPT,
 	UI_BLIND_SIGNING_ENABLE_WARNING,
 	UI_BLIND_SIGNING_SETTINGS,
+	UI_PREHASHED_SIGNING_SETTINGS,
 	UI_BLIND_SIGNING_SETTING_GO_BACK
 };
 
 /** UI state enum */
 extern enum UI_STATE uiState;
 
-/** notification to restart the hash */
-extern unsigned char hashTainted;
+/** operation the parts coming in, and the review on screen, belong to */
+enum OPERATION {
+	OP_NONE,
+	OP_SIGN_TX,
+	OP_BLIND_SIGN,
+	OP_BLIND_SIGN_PREHASHED,
+	OP_SIGN_DATA,
+	OP_EXPORT_ACCOUNT_KEY
+};
+
+/** operation in flight, OP_NONE when the next part starts a new one */
+extern enum OPERATION operation;
 
 /** notification to refresh the view, if we are displaying the public key */
 extern unsigned char publicKeyNeedsRefresh;
@@ -83,21 +104,30 @@ extern unsigned char publicKeyNeedsRefresh;
 /** index of the current screen. */
 extern unsigned int curr_scr_ix;
 
-/** hash. */
-extern unsigned char hash_data[HASH_DATA_SIZE];
+/** sha256 of the kryo serialization of the transaction. */
+extern unsigned char tx_hash[CX_SHA256_SIZE];
 
-/** current length of hash. */
-extern unsigned int hash_data_ix;
+/** length of the kryo text serialization of the transaction. */
+extern unsigned int tx_text_len;
 
 /** Is blind signing enabled */
 extern bool blind_signing_enabled_bool;
 
+/** Is blind signing of a digest the host hashed enabled, it can authorize a transaction. */
+extern bool prehashed_signing_enabled_bool;
+
 /** currently displayed text description. */
 extern char curr_tx_desc[MAX_TX_TEXT_LINES][MAX_TX_TEXT_WIDTH];
 
 /** currently displayed public key */
 extern char current_public_key[MAX_TX_TEXT_LINES][MAX_TX_TEXT_WIDTH];
 
+/** the account level path whose key is being exported. */
+extern unsigned int account_key_path[BIP44_ACCOUNT_PATH_LEN];
+
+/** sha512 of the blind signed message, or the structured data, with its header. finished when the last part comes in. */
+extern unsigned char msg_hash[CX_SHA512_SIZE];
+
 /** process a partial transaction */
 const bagl_element_t * io_seproxyhal_touch_approve(const bagl_element_t *e);
 
@@ -113,6 +143,12 @@ void ui_top_sign(void);
 /** show the "Blind Signing" ui, starting at the top of the blind signing display */
 void ui_top_blind_signing(void);
 
+/** show the "Sign Data" ui, starting at the top of the structured data display */
+void ui_top_sign_data(void);
+
+/** show the "Export Account Key" ui, for account_key_path */
+void ui_top_export_account_key(void);
+
 /** show the "Blind signing must be enabled" flow */
 void ui_blind_singing_must_enable_message(void);
 
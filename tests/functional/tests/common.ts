@@ -18,9 +18,9 @@ export const models = {
 };
 
 export const EXPECTED_TRANSACTION_SIGNATURE =
-  "3045022100915681c8851a21d15fa893b660a734e260fb1df2f5a0283defb88e756ad8feac022039be2cb81ecc2e2d2b51b851b0a6aa3b09250a7a1f9f532c0af89054c4135e60ffff9210b2122e9288e04a327505e3f24c4c363e0b0c4929a41a571c0bd452cacf9dffff03326332343044414737754d5a4c39583774356847376a59376b6b6d64466477796875363565784b763639386131343044414736714468615177686a5352706d57544665364754764c4e39587767694442586b4c4d6f734b3831326237343238303634643938623361646261633636323862373162643962623066313061333864356339616133316232386662353830636239613830383039386430626232313239303232303130313431666366383664376536393662369000";
+  "3045022100915681c8851a21d15fa893b660a734e260fb1df2f5a0283defb88e756ad8feac022039be2cb81ecc2e2d2b51b851b0a6aa3b09250a7a1f9f532c0af89054c4135e60ffff9210b2122e9288e04a327505e3f24c4c363e0b0c4929a41a571c0bd452cacf9dffff03f60232343044414737754d5a4c39583774356847376a59376b6b6d64466477796875363565784b763639386131343044414736714468615177686a5352706d57544665364754764c4e39587767694442586b4c4d6f734b3831326237343238303634643938623361646261633636323862373162643962623066313061333864356339616133316232386662353830636239613830383039386430626232313239303232303130313431666366383664376536393662369000";
 export const EXPECTED_TRANSACTION_SIGNATURE_SP =
-  "3045022100915681c8851a21d15fa893b660a734e260fb1df2f5a0283defb88e756ad8feac022039be2cb81ecc2e2d2b51b851b0a6aa3b09250a7a1f9f532c0af89054c4135e60ffff9210b2122e9288e04a327505e3f24c4c363e0b0c4929a41a571c0bd452cacf9dffff03303032343044414737754d5a4c39583774356847376a59376b6b6d64466477796875363565784b763639386131343044414736714468615177686a5352706d57544665364754764c4e39587767694442586b4c4d6f734b3831326237343238303634643938623361646261633636323862373162643962623066313061333864356339616133316232386662353830636239613830383039386430626232313239303232303130313431666366383664376536393662369000";
+  "3045022100915681c8851a21d15fa893b660a734e260fb1df2f5a0283defb88e756ad8feac022039be2cb81ecc2e2d2b51b851b0a6aa3b09250a7a1f9f532c0af89054c4135e60ffff9210b2122e9288e04a327505e3f24c4c363e0b0c4929a41a571c0bd452cacf9dffff03f60232343044414737754d5a4c39583774356847376a59376b6b6d64466477796875363565784b763639386131343044414736714468615177686a5352706d57544665364754764c4e39587767694442586b4c4d6f734b3831326237343238303634643938623361646261633636323862373162643962623066313061333864356339616133316232386662353830636239613830383039386430626232313239303232303130313431666366383664376536393662369000";
 export const EXPECTED_MESSAGE_SIGNATURE =
   "304402201148a139f0857bf4e5e607659a27b9fc7c5df39a97a86a368a0dd449c8e42da602206daef697166438210afdc61ee3516c1025abeed986eb98de14d347e62b9b39749000";
 export const APP_SEED =
@@ -29,3 +29,72 @@ export const BIP_PATH = "8000002C80000471800000000000000000000000";
 export const TX_HEX_DATA_BUFFER_1 = Buffer.from(TX_CHUNK_1, "hex");
 export const TX_HEX_DATA_BUFFER_2 = Buffer.from(TX_CHUNK_2 + BIP_PATH, "hex");
 export const MSG_HEX_DATA_BUFFER_1 = Buffer.from(MSG_CHUNK_1 + BIP_PATH, "hex");
+export const ACCOUNT_PATH = BIP_PATH.substring(0, 24);
+/** the public key of BIP_PATH, m/44'/1137'/0'/0/0, for APP_SEED, and its address, computed apart from the app. */
+export const EXPECTED_PUBLIC_KEY =
+  "04598f922b6786d82121b11ab74fe9b59edc5e5606df477d0158dd75934e94710b375cb87166b68ae6b451dff858ffedfee4af6afc2dd8075974c912f98e5cc0a3";
+export const EXPECTED_ADDRESS = "DAG0BphYLQAytER2ThLNxtbdSbFEuVZC7TnYUYsG";
+
+const BN = require("bn.js");
+const EC = require("elliptic").ec;
+const Crypto = require("crypto");
+const secp256k1 = new EC("secp256k1");
+
+const PUBLIC_KEY_PREFIX =
+  "3056301006072a8648ce3d020106052b8104000a034200";
+const BASE58_ALPHABET =
+  "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+const BASE58_ENCODED_ADDRESS_SUFFIX_LEN = 36;
+
+/** the DAG address of an uncompressed public key, as the app displays it. */
+export function publicKeyAddress(publicKey: Buffer): string {
+  const hash = Crypto.createHash("sha256")
+    .update(Buffer.concat([Buffer.from(PUBLIC_KEY_PREFIX, "hex"), publicKey]))
+    .digest();
+  let value = new BN(hash);
+  let encoded = "";
+  while (encoded.length < BASE58_ENCODED_ADDRESS_SUFFIX_LEN) {
+    encoded = BASE58_ALPHABET[value.modn(58)] + encoded;
+    value = value.divn(58);
+  }
+  let sum = 0;
+  for (const letter of encoded) {
+    if (letter >= "0" && letter <= "9") {
+      sum += letter.charCodeAt(0) - 48;
+    }
+  }
+  return "DAG" + (sum % 9) + encoded;
+}
+
+/** the uncompressed public key of a non-hardened BIP32 child, derived from its parent's public key and chain code. */
+export function deriveChild(
+  publicKey: Buffer,
+  chainCode: Buffer,
+  index: number
+): { publicKey: Buffer; chainCode: Buffer } {
+  const parent = secp256k1.keyFromPublic(publicKey).getPublic();
+  const data = Buffer.alloc(37);
+  Buffer.from(parent.encodeCompressed()).copy(data, 0);
+  data.writeUInt32BE(index, 33);
+  const I = Crypto.createHmac("sha512", chainCode).update(data).digest();
+  const child = secp256k1.g.mul(I.subarray(0, 32).toString("hex")).add(parent);
+  return {
+    publicKey: Buffer.from(child.encode("array", false)),
+    chainCode: I.subarray(32),
+  };
+}
+
+/** the addresses of the first count indexes of an account's external chain, derived from its exported key. */
+export function accountAddresses(accountKey: Buffer, count: number): string[] {
+  const external = deriveChild(
+    accountKey.subarray(0, 65),
+    accountKey.subarray(65, 97),
+    0
+  );
+  const addresses = [];
+  for (let index = 0; index < count; index++) {
+    const child = deriveChild(external.publicKey, external.chainCode, index);
+    addresses.push(publicKeyAddress(child.publicKey));
+  }
+  return addresses;
+}
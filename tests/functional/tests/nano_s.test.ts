@@ -2,8 +2,14 @@ import Zemu, { DEFAULT_START_OPTIONS } from "@zondax/zemu";
 const LCTI = require("ledger-constellation-transport-interface");
 
 import {
+  ACCOUNT_PATH,
   APP_SEED,
+  accountAddresses,
+  deriveChild,
+  publicKeyAddress,
   BIP_PATH,
+  EXPECTED_ADDRESS,
+  EXPECTED_PUBLIC_KEY,
   EXPECTED_TRANSACTION_SIGNATURE,
   EXPECTED_MESSAGE_SIGNATURE,
   TX_HEX_DATA_BUFFER_1,
@@ -64,6 +70,7 @@ describe("Nano S", function () {
       await sim.clickBoth();
       await sim.clickBoth();
       await sim.clickRight();
+      await sim.clickRight();
       await sim.clickBoth();
 
       transport
@@ -389,6 +396,7 @@ describe("Nano S", function () {
       await sim.clickBoth();
       await sim.clickBoth();
       await sim.clickRight();
+      await sim.clickRight();
       await sim.clickBoth();
 
       transport
@@ -425,6 +433,7 @@ describe("Nano S", function () {
       await sim.clickBoth();
       await sim.clickBoth();
       await sim.clickRight();
+      await sim.clickRight();
       await sim.clickBoth();
 
       transport
@@ -463,6 +472,7 @@ describe("Nano S", function () {
       await sim.clickBoth();
       await sim.clickBoth();
       await sim.clickRight();
+      await sim.clickRight();
       await sim.clickBoth();
 
       transport
@@ -501,6 +511,7 @@ describe("Nano S", function () {
       await sim.clickBoth();
       await sim.clickBoth();
       await sim.clickRight();
+      await sim.clickRight();
       await sim.clickBoth();
 
       transport
@@ -529,4 +540,82 @@ describe("Nano S", function () {
       await sim.close();
     }
   });
+  test("Should export an account key the host derives the app's addresses from", async function () {
+    const sim = new Zemu(models.nano_s.path);
+    try {
+      await sim.start({ ...defaultOptions, model: models.nano_s.name });
+      const transport = sim.getTransport();
+
+      const exported = transport.send(
+        0x80,
+        0x0e,
+        0x00,
+        0x00,
+        Buffer.from(ACCOUNT_PATH, "hex"),
+        [0x9000]
+      );
+
+      await sim.waitUntilScreenIsNot(sim.getMainMenuSnapshot());
+
+      // Export account key, through each screen of the review.
+      await sim.clickLeft();
+      await sim.clickLeft();
+      await sim.clickBoth();
+
+      const accountKey = await exported;
+      expect(accountKey.length).toEqual(65 + 32 + 2);
+
+      // m/44'/1137'/0'/0/0 derived from the export is the key, and address, known for the seed.
+      const external = deriveChild(
+        accountKey.subarray(0, 65),
+        accountKey.subarray(65, 97),
+        0
+      );
+      const first = deriveChild(external.publicKey, external.chainCode, 0);
+      expect(first.publicKey.toString("hex")).toEqual(EXPECTED_PUBLIC_KEY);
+      expect(publicKeyAddress(first.publicKey)).toEqual(EXPECTED_ADDRESS);
+
+      // the first addresses of the external chain, as the app derives them.
+      const buffer = await transport.send(
+        0x80,
+        0x0c,
+        0x00,
+        0x01,
+        Buffer.concat([Buffer.from(BIP_PATH, "hex"), Buffer.from([6])]),
+        [0x9000]
+      );
+      const count = buffer[0];
+      const expected = accountAddresses(accountKey, count);
+      for (let index = 0; index < count; index++) {
+        const address = buffer
+          .subarray(1 + index * 40, 1 + (index + 1) * 40)
+          .toString("ascii");
+        expect(address).toEqual(expected[index]);
+      }
+    } finally {
+      await sim.close();
+    }
+  });
+  test("Should not answer a transaction part with a pending account key export", async function () {
+    const sim = new Zemu(models.nano_s.path);
+    try {
+      await sim.start({ ...defaultOptions, model: models.nano_s.name });
+      const transport = sim.getTransport();
+
+      // the export is left waiting on its review, it is dropped by the transaction.
+      transport
+        .send(0x80, 0x0e, 0x00, 0x00, Buffer.from(ACCOUNT_PATH, "hex"), [0x9000])
+        .catch(() => undefined);
+
+      await sim.waitUntilScreenIsNot(sim.getMainMenuSnapshot());
+
+      // a transaction part is only acknowledged, without the key and chain code.
+      const part = await transport.send(0x80, 0x02, 0x00, 0x00, TX_HEX_DATA_BUFFER_1, [
+        0x9000,
+      ]);
+      expect(part.length).toEqual(2);
+    } finally {
+      await sim.close();
+    }
+  });
 });
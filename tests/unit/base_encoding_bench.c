@@ -0,0 +1,223 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+/**
+ * host benchmark for the encode_base_* encoders.
+ * checks every encoder against a one-digit-per-pass reference bignum on random inputs,
+ * then times each encoder over input sizes 1 to BASEX_DIVISION_BUFFER_SIZE bytes and a few bit patterns,
+ * writing one CSV row per measurement.
+ *
+ * usage: base_encoding_bench [--check-only] [results.csv]
+ * the results go to stdout when no file is given.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../../src/base-encoding.h"
+
+/** longest encoding of BASEX_DIVISION_BUFFER_SIZE bytes, which is base 2. */
+#define MAX_OUTPUT_LEN (BASEX_DIVISION_BUFFER_SIZE * 8)
+
+/** number of random inputs per encoder in the differential check. */
+#define CHECK_ROUNDS 2000
+
+/** each measurement repeats the encoder until at least this much time has passed. */
+#define MIN_SAMPLE_NS 2000000ULL
+
+/** and at least this many times. */
+#define MIN_SAMPLE_CALLS 16
+
+typedef unsigned int (*encoder_t)(const void *in, const unsigned int in_length,
+                                  char *out, const unsigned int out_length,
+                                  const bool enable_debug);
+
+typedef struct {
+    const char *name;
+    unsigned int base;
+    const char *alphabet;
+    encoder_t encode;
+} bench_encoder_t;
+
+static const bench_encoder_t ENCODERS[] = {
+    { "encode_base_2", 2, "01", encode_base_2 },
+    { "encode_base_10", 10, "0123456789", encode_base_10 },
+    { "encode_base_16", 16, "0123456789abcdef", encode_base_16 },
+    { "encode_base_32", 32, "13456789ABCDEFGHIJKMNOPQRSTUWXYZ", encode_base_32 },
+    { "encode_base_58", 58, "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz", encode_base_58 },
+};
+
+#define ENCODER_COUNT (sizeof(ENCODERS) / sizeof(ENCODERS[0]))
+
+typedef enum {
+    PATTERN_ZERO,
+    PATTERN_LEADING_ZERO,
+    PATTERN_MAX,
+    PATTERN_RANDOM,
+    PATTERN_COUNT
+} pattern_t;
+
+static const char *PATTERN_NAMES[PATTERN_COUNT] = { "zero", "leading_zero", "max", "random" };
+
+/** keeps the compiler from dropping the timed calls. */
+static volatile unsigned int bench_sink;
+
+void test_throw(unsigned short error) {
+    fprintf(stderr, "unexpected throw 0x%04X\n", error);
+    exit(2);
+}
+
+/** number of letters needed for the largest in_len byte value in base. */
+static unsigned int encoded_len(unsigned int base, unsigned int in_len) {
+    switch (base) {
+    case 2:
+        return in_len * 8;
+    case 10:
+        // log(256)/log(10) is just under 2.409.
+        return ((in_len * 2409) + 999) / 1000;
+    case 16:
+        return in_len * 2;
+    case 32:
+        return ((in_len * 8) + 4) / 5;
+    default:
+        return BASE_58_ENCODED_MAX_LEN(in_len);
+    }
+}
+
+/** the reference bignum, one digit per long division pass over the bytes, left padded with the zero letter. */
+static void reference_encode(const bench_encoder_t *encoder, const unsigned char *in, unsigned int in_len,
+                             char *out, unsigned int out_len) {
+    unsigned char divided[BASEX_DIVISION_BUFFER_SIZE];
+    memcpy(divided, in, in_len);
+
+    for (int out_ix = out_len - 1; out_ix >= 0; out_ix--) {
+        unsigned int remainder = 0;
+        for (unsigned int ix = 0; ix < in_len; ix++) {
+            unsigned int divided_part = (remainder << 8) | divided[ix];
+            divided[ix] = divided_part / encoder->base;
+            remainder = divided_part % encoder->base;
+        }
+        out[out_ix] = encoder->alphabet[remainder];
+    }
+}
+
+static void fill_pattern(unsigned char *in, unsigned int in_len, pattern_t pattern) {
+    for (unsigned int ix = 0; ix < in_len; ix++) {
+        switch (pattern) {
+        case PATTERN_ZERO:
+            in[ix] = 0x00;
+            break;
+        case PATTERN_LEADING_ZERO:
+            in[ix] = (ix < (in_len / 2)) ? 0x00 : (unsigned char) rand();
+            break;
+        case PATTERN_MAX:
+            in[ix] = 0xFF;
+            break;
+        default:
+            in[ix] = (unsigned char) rand();
+            break;
+        }
+    }
+}
+
+/** compares one encoder to the reference on random lengths and patterns, returns the number of mismatches. */
+static unsigned int check_encoder(const bench_encoder_t *encoder) {
+    unsigned char in[BASEX_DIVISION_BUFFER_SIZE];
+    char expected[MAX_OUTPUT_LEN];
+    char actual[MAX_OUTPUT_LEN];
+    unsigned int failures = 0;
+
+    for (unsigned int round = 0; round < CHECK_ROUNDS; round++) {
+        unsigned int in_len = 1 + (rand() % BASEX_DIVISION_BUFFER_SIZE);
+        fill_pattern(in, in_len, rand() % PATTERN_COUNT);
+        unsigned int out_len = encoded_len(encoder->base, in_len);
+
+        reference_encode(encoder, in, in_len, expected, out_len);
+        unsigned int actual_len = encoder->encode(in, in_len, actual, out_len, false);
+
+        if ((actual_len != out_len) || (memcmp(actual, expected, out_len) != 0)) {
+            fprintf(stderr, "%s mismatch on %u input bytes\n", encoder->name, in_len);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ULL) + (uint64_t) ts.tv_nsec;
+}
+
+static void bench_encoder(FILE *results, const bench_encoder_t *encoder) {
+    unsigned char in[BASEX_DIVISION_BUFFER_SIZE];
+    char out[MAX_OUTPUT_LEN];
+
+    for (unsigned int pattern = 0; pattern < PATTERN_COUNT; pattern++) {
+        for (unsigned int in_len = 1; in_len <= BASEX_DIVISION_BUFFER_SIZE; in_len++) {
+            fill_pattern(in, in_len, pattern);
+            unsigned int out_len = encoded_len(encoder->base, in_len);
+
+            uint64_t calls = 0;
+            uint64_t start = now_ns();
+            uint64_t elapsed = 0;
+            while ((calls < MIN_SAMPLE_CALLS) || (elapsed < MIN_SAMPLE_NS)) {
+                bench_sink += encoder->encode(in, in_len, out, out_len, false);
+                bench_sink += (unsigned char) out[0];
+                calls++;
+                elapsed = now_ns() - start;
+            }
+
+            fprintf(results, "%s,%u,%s,%u,%u,%llu,%.1f\n", encoder->name, encoder->base, PATTERN_NAMES[pattern],
+                    in_len, out_len, (unsigned long long) calls, (double) elapsed / (double) calls);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    bool check_only = false;
+    const char *results_path = NULL;
+    for (int arg_ix = 1; arg_ix < argc; arg_ix++) {
+        if (strcmp(argv[arg_ix], "--check-only") == 0) {
+            check_only = true;
+        } else {
+            results_path = argv[arg_ix];
+        }
+    }
+
+    srand(1);
+
+    unsigned int failures = 0;
+    for (unsigned int ix = 0; ix < ENCODER_COUNT; ix++) {
+        failures += check_encoder(&ENCODERS[ix]);
+    }
+    if (failures != 0) {
+        fprintf(stderr, "%u differential failures\n", failures);
+        return 1;
+    }
+    if (check_only) {
+        return 0;
+    }
+
+    FILE *results = stdout;
+    if (results_path != NULL) {
+        results = fopen(results_path, "w");
+        if (results == NULL) {
+            perror(results_path);
+            return 1;
+        }
+    }
+
+    fprintf(results, "encoder,base,pattern,input_len,output_len,calls,ns_per_call\n");
+    for (unsigned int ix = 0; ix < ENCODER_COUNT; ix++) {
+        bench_encoder(results, &ENCODERS[ix]);
+    }
+
+    if (results != stdout) {
+        fclose(results);
+    }
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "../../src/base-encoding.h"
+
+#define MAX_INPUT_LEN 40
+
+#define MAX_OUTPUT_LEN 100
+
+void test_throw(unsigned short error) {
+    fail_msg("unexpected throw 0x%04X", error);
+}
+
+/** the original encoder, one decimal digit per long division pass over the bytes. */
+static void reference_base_10(const unsigned char *in, unsigned int in_len, char *out, unsigned int out_len) {
+    unsigned char divided[MAX_INPUT_LEN];
+    memcpy(divided, in, in_len);
+    memset(out, '0', out_len);
+
+    for (int out_ix = out_len - 1; out_ix >= 0; out_ix--) {
+        unsigned int remainder = 0;
+        for (unsigned int ix = 0; ix < in_len; ix++) {
+            unsigned int divided_part = (remainder << 8) | divided[ix];
+            divided[ix] = divided_part / 10;
+            remainder = divided_part % 10;
+        }
+        out[out_ix] = '0' + remainder;
+    }
+}
+
+static void assert_base_10_matches(const unsigned char *in, unsigned int in_len) {
+    char expected[MAX_OUTPUT_LEN];
+    char actual[MAX_OUTPUT_LEN];
+
+    reference_base_10(in, in_len, expected, MAX_OUTPUT_LEN);
+    unsigned int actual_len = encode_base_10(in, in_len, actual, MAX_OUTPUT_LEN, false);
+
+    assert_int_equal(actual_len, MAX_OUTPUT_LEN);
+    assert_memory_equal(actual, expected, MAX_OUTPUT_LEN);
+}
+
+static void base_10_fixed_test(void **state) {
+    unsigned char zero[8] = { 0 };
+    assert_base_10_matches(zero, sizeof(zero));
+
+    // 10^9, the chunk boundary.
+    unsigned char billion[4] = { 0x3B, 0x9A, 0xCA, 0x00 };
+    assert_base_10_matches(billion, sizeof(billion));
+
+    // 10^9 - 1, a chunk full of nines.
+    unsigned char below_billion[4] = { 0x3B, 0x9A, 0xC9, 0xFF };
+    assert_base_10_matches(below_billion, sizeof(below_billion));
+
+    // 10^4 and 10^4 - 1, the chunk boundary of the half limb divide.
+    unsigned char ten_thousand[2] = { 0x27, 0x10 };
+    assert_base_10_matches(ten_thousand, sizeof(ten_thousand));
+    unsigned char below_ten_thousand[2] = { 0x27, 0x0F };
+    assert_base_10_matches(below_ten_thousand, sizeof(below_ten_thousand));
+
+    unsigned char max[MAX_INPUT_LEN];
+    memset(max, 0xFF, sizeof(max));
+    assert_base_10_matches(max, sizeof(max));
+
+    // the amount from the selector test transaction, as the display formats it.
+    unsigned char amount[4] = { 0x12, 0xB7, 0x42, 0x80 };
+    char amount_base10[17];
+    encode_base_10(amount, sizeof(amount), amount_base10, sizeof(amount_base10), false);
+    assert_memory_equal(amount_base10, "00000000314000000", sizeof(amount_base10));
+}
+
+static void base_10_random_test(void **state) {
+    unsigned char in[MAX_INPUT_LEN];
+    srand(1137);
+
+    for (unsigned int iteration = 0; iteration < 2000; iteration++) {
+        unsigned int in_len = 1 + (rand() % MAX_INPUT_LEN);
+        unsigned int leading_zeros = rand() % (in_len + 1);
+        for (unsigned int ix = 0; ix < in_len; ix++) {
+            in[ix] = (ix < leading_zeros) ? 0x00 : (unsigned char)rand();
+        }
+        assert_base_10_matches(in, in_len);
+    }
+}
+
+/** collects the letters from encode_base_stream. */
+typedef struct {
+    char text[MAX_OUTPUT_LEN];
+    unsigned int text_len;
+} streamed_t;
+
+static void collect_text(void *context, const char *text, const unsigned int text_len) {
+    streamed_t *streamed = context;
+    assert_true(streamed->text_len + text_len <= MAX_OUTPUT_LEN);
+    memcpy(streamed->text + streamed->text_len, text, text_len);
+    streamed->text_len += text_len;
+}
+
+static void base_10_stream_test(void **state) {
+    unsigned char in[MAX_INPUT_LEN];
+    uint32_t scratch[BASEX_CHUNKS_SCRATCH_LIMBS(MAX_INPUT_LEN)];
+    char expected[MAX_OUTPUT_LEN];
+    srand(2203);
+
+    for (unsigned int iteration = 0; iteration < 2000; iteration++) {
+        unsigned int in_len = rand() % (MAX_INPUT_LEN + 1);
+        unsigned int leading_zeros = rand() % (in_len + 1);
+        for (unsigned int ix = 0; ix < in_len; ix++) {
+            in[ix] = (ix < leading_zeros) ? 0x00 : (unsigned char)rand();
+        }
+
+        // the significant digits, with at least one zero.
+        reference_base_10(in, in_len, expected, MAX_OUTPUT_LEN);
+        unsigned int expected_start = 0;
+        while ((expected_start < MAX_OUTPUT_LEN - 1) && (expected[expected_start] == '0')) {
+            expected_start++;
+        }
+        unsigned int expected_len = MAX_OUTPUT_LEN - expected_start;
+
+        streamed_t streamed = { .text_len = 0 };
+        unsigned int letters_len = encode_base_chunks(10, in, in_len, scratch, BASEX_CHUNKS_SCRATCH_LIMBS(in_len));
+        encode_base_stream(10, scratch, BASEX_CHUNKS_SCRATCH_LIMBS(in_len), letters_len, collect_text, &streamed);
+
+        assert_int_equal(letters_len, expected_len);
+        assert_int_equal(streamed.text_len, expected_len);
+        assert_memory_equal(streamed.text, expected + expected_start, expected_len);
+    }
+}
+
+int main(void) {
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(base_10_fixed_test),
+    cmocka_unit_test(base_10_random_test),
+    cmocka_unit_test(base_10_stream_test),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
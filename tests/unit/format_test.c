@@ -0,0 +1,94 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "../../src/format.h"
+
+/** where a throw from the app code lands, and the error it threw. */
+static jmp_buf throw_jump;
+static unsigned short thrown;
+
+void test_throw(unsigned short error) {
+    thrown = error;
+    longjmp(throw_jump, 1);
+}
+
+/** formats value onto the first screen, returns the error it threw, or 0. */
+static unsigned short display_value(uint64_t value, unsigned int decimals) {
+    unsigned char value_be[8];
+    for (unsigned int ix = 0; ix < sizeof(value_be); ix++) {
+        value_be[ix] = (unsigned char)(value >> (8 * (sizeof(value_be) - 1 - ix)));
+    }
+    if (setjmp(throw_jump) != 0) {
+        return thrown;
+    }
+    format_display_value(0, value_be, sizeof(value_be), decimals);
+    return 0;
+}
+
+static void assert_fixed_point(uint64_t value, unsigned int decimals, bool grouping, bool trim, const char *expected) {
+    char actual[32];
+    unsigned int actual_len = format_fixed_point(value, decimals, grouping, trim, actual, sizeof(actual));
+
+    assert_int_equal(actual_len, strlen(expected));
+    assert_string_equal(actual, expected);
+}
+
+static void fixed_point_test(void **state) {
+    assert_fixed_point(0, 8, false, false, "0.00000000");
+    assert_fixed_point(0, 8, false, true, "0");
+    assert_fixed_point(0, 0, false, false, "0");
+
+    // the amount in the functional test transaction.
+    assert_fixed_point(314000000, 8, false, false, "3.14000000");
+    assert_fixed_point(314000000, 8, false, true, "3.14");
+
+    // one datum, the smallest amount, keeps its leading zero.
+    assert_fixed_point(1, 8, false, false, "0.00000001");
+
+    assert_fixed_point(123456789012ULL, 8, true, false, "1,234.56789012");
+    assert_fixed_point(100000000000ULL, 8, true, true, "1,000");
+    assert_fixed_point(999, 0, true, false, "999");
+    assert_fixed_point(1000, 0, true, false, "1,000");
+
+    assert_fixed_point(UINT64_MAX, 8, false, false, "184467440737.09551615");
+    assert_fixed_point(UINT64_MAX, 8, true, false, "184,467,440,737.09551615");
+    assert_fixed_point(UINT64_MAX, 0, true, false, "18,446,744,073,709,551,615");
+}
+
+static void fixed_point_too_long_test(void **state) {
+    char dest[5];
+
+    assert_int_equal(format_fixed_point(1234, 0, false, false, dest, sizeof(dest)), 4);
+    assert_int_equal(format_fixed_point(12345, 0, false, false, dest, sizeof(dest)), 0);
+    assert_int_equal(format_fixed_point(1234, 0, true, false, dest, sizeof(dest)), 0);
+}
+
+static void display_value_test(void **state) {
+    assert_int_equal(display_value(314000000, 8), 0);
+    assert_string_equal(tx_desc[0][1], "3.14000000");
+    assert_string_equal(tx_desc[0][2], "");
+
+    // the most decimals a token can have, with the largest amount, wraps onto line 2.
+    assert_int_equal(display_value(UINT64_MAX, 19), 0);
+    assert_string_equal(tx_desc[0][1], "1.844674407370955");
+    assert_string_equal(tx_desc[0][2], "1615");
+
+    // more than both lines hold is an error, rather than a wrap of a negative length.
+    assert_int_equal(display_value(UINT64_MAX, 40), 0x6D26);
+}
+
+int main(void) {
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(fixed_point_test),
+    cmocka_unit_test(fixed_point_too_long_test),
+    cmocka_unit_test(display_value_test),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,83 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "../../src/keycache.h"
+
+/** a bip44 path that differs from the others in its address index. */
+static void make_path(unsigned char *path, unsigned char index) {
+    memset(path, 0x00, BIP44_BYTE_LENGTH);
+    path[BIP44_BYTE_LENGTH - 1] = index;
+}
+
+/** adds a key and address that are the path index repeated. */
+static void add(unsigned char index) {
+    unsigned char path[BIP44_BYTE_LENGTH];
+    unsigned char public_key[PUBLIC_KEY_LEN];
+    char address[ADDRESS_LEN];
+    make_path(path, index);
+    memset(public_key, index, sizeof(public_key));
+    memset(address, 'A' + index, sizeof(address));
+    key_cache_add(path, public_key, address);
+}
+
+static const key_cache_entry_t * find(unsigned char index) {
+    unsigned char path[BIP44_BYTE_LENGTH];
+    make_path(path, index);
+    return key_cache_find(path);
+}
+
+static void hit_miss_test(void **state) {
+    key_cache_wipe();
+    assert_null(find(1));
+    add(1);
+
+    const key_cache_entry_t *entry = find(1);
+    assert_non_null(entry);
+    assert_int_equal(entry->public_key[PUBLIC_KEY_LEN - 1], 1);
+    assert_int_equal(entry->address[0], 'B');
+    assert_null(find(2));
+
+    assert_int_equal(key_cache_hits(), 1);
+    assert_int_equal(key_cache_misses(), 2);
+}
+
+static void least_recently_used_test(void **state) {
+    key_cache_wipe();
+    for (unsigned char index = 0; index < KEY_CACHE_ENTRIES; index++) {
+        add(index);
+    }
+    // using the oldest makes the second oldest the one to go.
+    assert_non_null(find(0));
+    add(KEY_CACHE_ENTRIES);
+
+    assert_non_null(find(0));
+    assert_null(find(1));
+    for (unsigned char index = 2; index <= KEY_CACHE_ENTRIES; index++) {
+        assert_non_null(find(index));
+    }
+}
+
+static void wipe_test(void **state) {
+    add(3);
+    key_cache_wipe();
+    assert_int_equal(key_cache_hits(), 0);
+    assert_int_equal(key_cache_misses(), 0);
+    assert_null(find(3));
+}
+
+int main(void) {
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(hit_miss_test),
+    cmocka_unit_test(least_recently_used_test),
+    cmocka_unit_test(wipe_test),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
@@ -0,0 +1,219 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+/**
+ * host benchmark for the table driven kryo serializer.
+ * builds random transactions in raw_tx, checks the schema interpreter writes the same text as the
+ * hand written per field switch it replaced, then times both, writing one CSV row per measurement.
+ * the fields are decoded once, outside the timing, as they are for the display.
+ * each timed call does what signing does, measures the text, then sends it to a sink.
+ *
+ * usage: kryo_bench [--check-only] [results.csv]
+ * the results go to stdout when no file is given.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../../src/decoder.h"
+
+/** number of random transactions in the differential check. */
+#define CHECK_ROUNDS 2000
+
+/** samples taken of each serializer per transaction shape, the fastest is reported. */
+#define SAMPLES 7
+
+/** each sample repeats the serializer until at least this much time has passed. */
+#define MIN_SAMPLE_NS 5000000ULL
+
+/** and at least this many times. */
+#define MIN_SAMPLE_CALLS 16
+
+/** length of a parent address. */
+#define ADDRESS_TEXT_LEN 40
+
+/** length of a last tx ref hash. */
+#define HASH_TEXT_LEN 64
+
+/** most parents of a transaction kept whole in raw_tx, with the longest amount, hash, ordinal, fee and salt make_tx writes. */
+#define BENCH_MAX_PARENTS ((MAX_TX_RAW_LENGTH - (1 + 9 + (1 + HASH_TEXT_LEN) + 9 + 9 + 9)) / (1 + ADDRESS_TEXT_LEN))
+
+/** keeps the compiler from dropping the timed calls. */
+static volatile unsigned int bench_sink;
+
+void test_throw(unsigned short error) {
+    fprintf(stderr, "unexpected throw 0x%04X\n", error);
+    exit(2);
+}
+
+/** a running FNV-1a hash of everything sent to it. */
+static void fnv_sink(void *context, const char *text, const unsigned int text_len) {
+    uint32_t *fnv = context;
+    for (unsigned int ix = 0; ix < text_len; ix++) {
+        *fnv = (*fnv ^ (unsigned char) text[ix]) * 16777619u;
+    }
+}
+
+/** collects everything sent to it into a buffer. */
+typedef struct {
+    char text[MAX_TX_RAW_LENGTH * 2];
+    unsigned int len;
+} text_buffer_t;
+
+static void buffer_sink(void *context, const char *text, const unsigned int text_len) {
+    text_buffer_t *buffer = context;
+    memcpy(buffer->text + buffer->len, text, text_len);
+    buffer->len += text_len;
+}
+
+/** the hand written serializer the schema table replaced, in kryo_bench_baseline.c as it was in its own file in the app. */
+unsigned int baseline_serialize(text_sink_t sink, void *context);
+
+/** measures then hashes the decoded fields, as signing does. */
+static unsigned int baseline_sign(uint32_t *fnv) {
+    unsigned int text_len = baseline_serialize(NULL, NULL);
+    baseline_serialize(fnv_sink, fnv);
+    return text_len;
+}
+
+static unsigned int table_sign(uint32_t *fnv) {
+    unsigned int text_len = kryo_serialize(raw_tx, tx_fields, tx_fields_len, NULL, NULL);
+    kryo_serialize(raw_tx, tx_fields, tx_fields_len, fnv_sink, fnv);
+    return text_len;
+}
+
+static unsigned int add_field(unsigned int ix, unsigned int len, bool letters) {
+    raw_tx[ix++] = len;
+    for (unsigned int data_ix = 0; data_ix < len; data_ix++) {
+        raw_tx[ix++] = letters ? ('A' + (rand() % 26)) : (unsigned char) rand();
+    }
+    return ix;
+}
+
+/** writes a random v1 transaction with parent_count parents into raw_tx, and returns its length. */
+static unsigned int make_tx(unsigned int parent_count) {
+    unsigned int ix = 0;
+    raw_tx[ix++] = parent_count;
+    for (unsigned int parent_ix = 0; parent_ix < parent_count; parent_ix++) {
+        ix = add_field(ix, ADDRESS_TEXT_LEN, true);
+    }
+    ix = add_field(ix, 1 + (rand() % 8), false);
+    ix = add_field(ix, HASH_TEXT_LEN, true);
+    ix = add_field(ix, 1 + (rand() % 8), false);
+    ix = add_field(ix, 1 + (rand() % 8), false);
+    ix = add_field(ix, 1 + (rand() % 8), false);
+    return ix;
+}
+
+/** compares the interpreter to the baseline on random transactions, returns the number of mismatches. */
+static unsigned int check_serializer(void) {
+    static text_buffer_t expected;
+    static text_buffer_t actual;
+    unsigned int failures = 0;
+
+    for (unsigned int round = 0; round < CHECK_ROUNDS; round++) {
+        unsigned int parent_count = rand() % (BENCH_MAX_PARENTS + 1);
+        unsigned int raw_len = make_tx(parent_count);
+
+        decode_begin(&KRYO_TX_V1_SCHEMA);
+        decode_fields(raw_len);
+        expected.len = 0;
+        actual.len = 0;
+        unsigned int expected_len = baseline_serialize(buffer_sink, &expected);
+        unsigned int actual_len = kryo_serialize(raw_tx, tx_fields, tx_fields_len, buffer_sink, &actual);
+
+        if (!decode_complete(raw_len) || (actual_len != expected_len) || (actual.len != expected.len)
+                || (expected.len != expected_len) || (memcmp(actual.text, expected.text, expected.len) != 0)) {
+            fprintf(stderr, "mismatch on a tx with %u parents\n", parent_count);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ULL) + (uint64_t) ts.tv_nsec;
+}
+
+static void bench_serializers(FILE *results) {
+    for (unsigned int parent_count = 0; parent_count <= BENCH_MAX_PARENTS; parent_count++) {
+        unsigned int raw_len = make_tx(parent_count);
+        decode_begin(&KRYO_TX_V1_SCHEMA);
+        decode_fields(raw_len);
+        uint32_t fnv = 2166136261u;
+        unsigned int text_len = baseline_sign(&fnv);
+
+        // the serializers take turns, and each keeps its fastest sample, so machine noise hits both alike.
+        double best_ns[2] = { 0, 0 };
+        uint64_t best_calls[2] = { 0, 0 };
+        for (unsigned int sample = 0; sample < SAMPLES; sample++) {
+            for (unsigned int serializer = 0; serializer < 2; serializer++) {
+                uint64_t calls = 0;
+                uint64_t start = now_ns();
+                uint64_t elapsed = 0;
+                while ((calls < MIN_SAMPLE_CALLS) || (elapsed < MIN_SAMPLE_NS)) {
+                    fnv = 2166136261u;
+                    bench_sink += (serializer == 0) ? baseline_sign(&fnv) : table_sign(&fnv);
+                    bench_sink += fnv;
+                    calls++;
+                    elapsed = now_ns() - start;
+                }
+                double ns = (double) elapsed / (double) calls;
+                if ((sample == 0) || (ns < best_ns[serializer])) {
+                    best_ns[serializer] = ns;
+                    best_calls[serializer] = calls;
+                }
+            }
+        }
+
+        for (unsigned int serializer = 0; serializer < 2; serializer++) {
+            fprintf(results, "%s,%u,%u,%u,%llu,%.1f\n", (serializer == 0) ? "hand_written" : "schema_table",
+                    parent_count, raw_len, text_len, (unsigned long long) best_calls[serializer], best_ns[serializer]);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    bool check_only = false;
+    const char *results_path = NULL;
+    for (int arg_ix = 1; arg_ix < argc; arg_ix++) {
+        if (strcmp(argv[arg_ix], "--check-only") == 0) {
+            check_only = true;
+        } else {
+            results_path = argv[arg_ix];
+        }
+    }
+
+    srand(1);
+
+    unsigned int failures = check_serializer();
+    if (failures != 0) {
+        fprintf(stderr, "%u differential failures\n", failures);
+        return 1;
+    }
+    if (check_only) {
+        return 0;
+    }
+
+    FILE *results = stdout;
+    if (results_path != NULL) {
+        results = fopen(results_path, "w");
+        if (results == NULL) {
+            perror(results_path);
+            return 1;
+        }
+    }
+
+    fprintf(results, "serializer,parents,raw_len,text_len,calls,ns_per_call\n");
+    bench_serializers(results);
+
+    if (results != stdout) {
+        fclose(results);
+    }
+    return 0;
+}
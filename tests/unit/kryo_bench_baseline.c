@@ -0,0 +1,81 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+/**
+ * the hand written kryo serializer, a switch on which field each view is, as the app had it before the schema table.
+ * kryo_bench times the schema interpreter against it, and it is kept in its own file so neither gets inlined into the bench.
+ */
+#include <stdint.h>
+#include "../../src/base-encoding.h"
+#include "../../src/decoder.h"
+
+unsigned int baseline_serialize(text_sink_t sink, void *context);
+
+static unsigned int baseline_number(unsigned char number, text_sink_t sink, void *context) {
+    char digits[3];
+    unsigned int digits_len = 0;
+    if (number >= 100) {
+        digits[digits_len++] = '0' + (number / 100);
+    }
+    if (number >= 10) {
+        digits[digits_len++] = '0' + ((number / 10) % 10);
+    }
+    digits[digits_len++] = '0' + (number % 10);
+    if (sink != NULL) {
+        sink(context, digits, digits_len);
+    }
+    return digits_len;
+}
+
+static unsigned int baseline_data(const unsigned char *in, unsigned int len, text_sink_t sink, void *context) {
+    unsigned int text_len = baseline_number(len, sink, context);
+    if (sink != NULL) {
+        sink(context, (const char *) in, len);
+    }
+    return text_len + len;
+}
+
+static unsigned int baseline_base10(const unsigned char *in, unsigned int len, text_sink_t sink, void *context) {
+    uint32_t scratch[BASEX_CHUNKS_SCRATCH_LIMBS(8)];
+    unsigned int base10_len = encode_base_chunks(10, in, len, scratch, BASEX_CHUNKS_SCRATCH_LIMBS(8));
+    unsigned int text_len = baseline_number(base10_len, sink, context);
+    if (sink != NULL) {
+        encode_base_stream(10, scratch, BASEX_CHUNKS_SCRATCH_LIMBS(8), base10_len, sink, context);
+    }
+    return text_len + base10_len;
+}
+
+static unsigned int baseline_base16(const unsigned char *in, unsigned int len, text_sink_t sink, void *context) {
+    unsigned int base16_len = hex_significant_len(in, len);
+    unsigned int text_len = baseline_number(base16_len, sink, context);
+    if (sink != NULL) {
+        hex_stream(in, len, false, true, sink, context);
+    }
+    return text_len + base16_len;
+}
+
+/** sends the kryo text of one field, chosen by which field it is. */
+static unsigned int baseline_field(const tx_field_view_t *view, text_sink_t sink, void *context) {
+    const unsigned char *data = raw_tx + view->offset;
+    switch (view->field) {
+    case TX_FIELD_PARENT_COUNT:
+        return baseline_number(view->len, sink, context);
+    case TX_FIELD_PARENT:
+    case TX_FIELD_LAST_TX_REF_HASH:
+        return baseline_data(data, view->len, sink, context);
+    case TX_FIELD_AMOUNT:
+    case TX_FIELD_SALT:
+        return baseline_base16(data, view->len, sink, context);
+    default:
+        return baseline_base10(data, view->len, sink, context);
+    }
+}
+
+unsigned int baseline_serialize(text_sink_t sink, void *context) {
+    unsigned int text_len = 0;
+    for (unsigned int ix = 0; ix < tx_fields_len; ix++) {
+        text_len += baseline_field(tx_fields + ix, sink, context);
+    }
+    return text_len;
+}
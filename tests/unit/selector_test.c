@@ -9,10 +9,15 @@
 #include "../../src/shared.h"
 #include "../../src/selector.h"
 
+void test_throw(unsigned short error) {
+    fail_msg("unexpected throw 0x%04X", error);
+}
+
 unsigned int raw_tx_ix = 0;
-unsigned int raw_tx_len = 167;
+unsigned int raw_tx_len = 0;
 
-raw_tx = {
+/** the transaction of the functional tests, copied into raw_tx as INS_SIGN would leave it. */
+static const unsigned char SELECTOR_TX[] = {
     0x02, 0x28, 0x44, 0x41,
     0x47, 0x37, 0x75, 0x4d, 0x5a,
     0x4c, 0x39, 0x58, 0x37, 0x74, 
@@ -51,6 +56,8 @@ raw_tx = {
 static void selector_test(void **state) {
 
     memset(tx_desc, 0x00, sizeof(tx_desc));
+    memmove(raw_tx, SELECTOR_TX, sizeof(SELECTOR_TX));
+    raw_tx_len = sizeof(SELECTOR_TX);
 
     select_display_fields();
 
@@ -61,13 +68,12 @@ static void selector_test(void **state) {
     assert_string_equal(tx_desc[1][1], "DAG6q...LMosK");
 
     // Amount
-    assert_true(tx_desc[2][1][0] == 0x12);
-    assert_true(tx_desc[2][1][1] == 0xffffffb7);
-    assert_true(tx_desc[2][1][2] == 0x42);
-    assert_true(tx_desc[2][1][3] == 0xffffff80);
+    assert_string_equal(tx_desc[2][0], "$DAG");
+    assert_string_equal(tx_desc[2][1], "3.14000000");
 
     // Fee
-    assert_true(tx_desc[3][1][0] == 0);
+    assert_string_equal(tx_desc[3][0], "FEE");
+    assert_string_equal(tx_desc[3][1], "0");
 
 
 }
@@ -0,0 +1,173 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "../../src/signdata.h"
+
+/** where a throw from the app code lands, and the error it threw. */
+static jmp_buf throw_jump;
+static unsigned short thrown;
+
+void test_throw(unsigned short error) {
+    thrown = error;
+    longjmp(throw_jump, 1);
+}
+
+static const char DATA[] = "{\"amount\":100,\"name\":\"abc\",\"nested\":{\"a\":\"x\",\"b\":[1,true,null]}}";
+
+static const char DATA_BASE64[] = "eyJhbW91bnQiOjEwMCwibmFtZSI6ImFiYyIsIm5lc3RlZCI6eyJhIjoieCIsImIiOlsxLHRydWUsbnVsbF19fQ==";
+
+static const unsigned char BIP44_PATH[] = {
+    0x80, 0x00, 0x00, 0x2c, 0x80, 0x00, 0x04, 0x71, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+/** collects the base64 letters. */
+typedef struct {
+    char text[256];
+    unsigned int len;
+} text_buffer_t;
+
+static void buffer_sink(void *context, const char *text, const unsigned int text_len) {
+    text_buffer_t *buffer = context;
+    memcpy(buffer->text + buffer->len, text, text_len);
+    buffer->len += text_len;
+    buffer->text[buffer->len] = '\0';
+}
+
+/** writes the framing for data, picking keys, followed by the data and the bip44 path, into apdu. returns its length. */
+static unsigned int frame(unsigned char *apdu, const char *data, const char **keys, unsigned int keys_len) {
+    unsigned int data_len = strlen(data);
+    unsigned int ix = 0;
+    apdu[ix++] = data_len >> 24;
+    apdu[ix++] = data_len >> 16;
+    apdu[ix++] = data_len >> 8;
+    apdu[ix++] = data_len;
+    apdu[ix++] = keys_len;
+    for (unsigned int key_ix = 0; key_ix < keys_len; key_ix++) {
+        apdu[ix++] = strlen(keys[key_ix]);
+        memcpy(apdu + ix, keys[key_ix], strlen(keys[key_ix]));
+        ix += strlen(keys[key_ix]);
+    }
+    memcpy(apdu + ix, data, data_len);
+    ix += data_len;
+    memcpy(apdu + ix, BIP44_PATH, sizeof(BIP44_PATH));
+    return ix + sizeof(BIP44_PATH);
+}
+
+/** signs the data in chunks of chunk_len bytes, returns 0 or the error thrown, and the base64 in out. */
+static unsigned short sign(const char *data, const char **keys, unsigned int keys_len, unsigned int chunk_len, text_buffer_t *out) {
+    unsigned char apdu[512];
+    unsigned int apdu_len = frame(apdu, data, keys, keys_len);
+    out->len = 0;
+    out->text[0] = '\0';
+
+    if (setjmp(throw_jump) != 0) {
+        return thrown;
+    }
+    unsigned int ix = sign_data_begin(apdu, apdu_len);
+    unsigned int path_ix = 0;
+    while (ix < apdu_len) {
+        unsigned int len = (apdu_len - ix < chunk_len) ? apdu_len - ix : chunk_len;
+        unsigned int data_len = sign_data_chunk(apdu + ix, len, buffer_sink, out);
+        // what follows the data is the bip44 path.
+        assert_memory_equal(apdu + ix + data_len, BIP44_PATH + path_ix, len - data_len);
+        path_ix += len - data_len;
+        ix += len;
+    }
+    assert_int_equal(path_ix, sizeof(BIP44_PATH));
+    sign_data_end(buffer_sink, out);
+    return 0;
+}
+
+static void sign_data_test(void **state) {
+    const char *keys[] = { "amount", "nested", "missing" };
+    text_buffer_t out;
+
+    assert_int_equal(sign(DATA, keys, 3, 255, &out), 0);
+    assert_string_equal(out.text, DATA_BASE64);
+
+    char header[SIGN_DATA_HEADER_MAX_LEN];
+    unsigned int header_len = sign_data_header(header);
+    assert_int_equal(header_len, 31);
+    assert_memory_equal(header, "\x19" "Constellation Signed Data:\n88\n", header_len);
+
+    assert_int_equal(max_scr_ix, 4);
+    assert_string_equal(tx_desc[0][0], "Signed Data");
+    assert_string_equal(tx_desc[0][1], "64 bytes");
+    assert_string_equal(tx_desc[1][0], "amount");
+    assert_string_equal(tx_desc[1][1], "100");
+    assert_string_equal(tx_desc[2][0], "nested");
+    assert_string_equal(tx_desc[2][1], "{\"a\":\"x\",\"b\":[1,t");
+    assert_string_equal(tx_desc[2][2], "rue,null]}");
+    assert_string_equal(tx_desc[3][0], "missing");
+    assert_string_equal(tx_desc[3][1], "(absent)");
+}
+
+static void sign_data_chunked_test(void **state) {
+    const char *keys[] = { "name" };
+    text_buffer_t out;
+
+    // every way of splitting the data across chunks gives the same letters.
+    for (unsigned int chunk_len = 1; chunk_len < 100; chunk_len++) {
+        assert_int_equal(sign(DATA, keys, 1, chunk_len, &out), 0);
+        assert_string_equal(out.text, DATA_BASE64);
+        assert_string_equal(tx_desc[1][1], "abc");
+    }
+
+    assert_int_equal(sign("{\"a\":1}", keys, 0, 3, &out), 0);
+    assert_string_equal(out.text, "eyJhIjoxfQ==");
+    assert_int_equal(sign("{\"a\":12}", keys, 0, 3, &out), 0);
+    assert_string_equal(out.text, "eyJhIjoxMn0=");
+}
+
+static void sign_data_not_canonical_test(void **state) {
+    text_buffer_t out;
+
+    assert_int_equal(sign("{\"a\": 1}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"b\":1,\"a\":2}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":1,\"a\":2}", NULL, 0, 255, &out), 0x6D41);
+    // the keys of nested objects are sorted too, each object on its own.
+    assert_int_equal(sign("{\"a\":{\"b\":1,\"a\":2}}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":{\"b\":1,\"b\":2}}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":[{\"x\":1},{\"y\":1,\"x\":2}]}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":{\"b\":{\"c\":1}},\"a\":2}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":{\"z\":1},\"b\":{\"a\":{\"a\":1,\"b\":2},\"b\":3}}", NULL, 0, 255, &out), 0);
+    assert_int_equal(sign("{\"a\":[{\"y\":1},{\"x\":2}]}", NULL, 0, 255, &out), 0);
+    assert_int_equal(sign("[1,2]", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":tru}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":[1}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":\"\\u0041\"}", NULL, 0, 255, &out), 0x6D41);
+    // a control character with a two letter escape has only that one.
+    assert_int_equal(sign("{\"a\":\"\\u000a\"}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":\"\\u0009\"}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":\"\\u005c\"}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":\"\\u0022\"}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":\"\\n\\u001f\"}", NULL, 0, 255, &out), 0);
+    // numbers follow the json grammar.
+    assert_int_equal(sign("{\"a\":1-+e}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":007}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":-}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":1.}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":.5}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":1e}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":1e+}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":+1}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":[0,-0.5,10,1.25e-3,2E+10,3e7]}", NULL, 0, 255, &out), 0);
+    assert_int_equal(sign("{\"a\":1}}", NULL, 0, 255, &out), 0x6D41);
+    assert_int_equal(sign("{\"a\":1", NULL, 0, 255, &out), 0x6D41);
+}
+
+int main(void) {
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(sign_data_test),
+    cmocka_unit_test(sign_data_chunked_test),
+    cmocka_unit_test(sign_data_not_canonical_test),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
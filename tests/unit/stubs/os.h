@@ -0,0 +1,18 @@
+/*
+ * MIT License, see root folder for full license.
+ */
+
+/** host stand-in for the BOLOS SDK os.h, just enough to build the encoders natively. */
+#ifndef OS_H
+#define OS_H
+
+#include <stdint.h>
+
+#define UNUSED(x) (void)(x)
+
+/** each test binary decides what an error thrown by the app code means. */
+void test_throw(unsigned short error);
+
+#define THROW(x) test_throw(x)
+
+#endif // OS_H
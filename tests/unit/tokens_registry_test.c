@@ -0,0 +1,84 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "../../src/format.h"
+#include "../../src/tokens.h"
+
+/** checks the app's own registry, src/tokens.def, the entries tokens_test.def stands in for elsewhere. */
+
+void test_throw(unsigned short error) {
+    fail_msg("unexpected throw 0x%04X", error);
+}
+
+/** the letters of a DAG address after its 4 letter prefix. */
+static const char BASE58_ALPHABET[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+static void registry_sorted_test(void **state) {
+    assert_true(token_count() > 0);
+    for (unsigned int ix = 1; ix < token_count(); ix++) {
+        // strictly increasing, so sorted for token_find and without a repeated identifier.
+        assert_true(memcmp(token_at(ix - 1)->id, token_at(ix)->id, TOKEN_ID_LEN) < 0);
+    }
+}
+
+static void registry_ids_test(void **state) {
+    for (unsigned int ix = 0; ix < token_count(); ix++) {
+        const char *id = token_at(ix)->id;
+        assert_memory_equal(id, "DAG", 3);
+
+        // the letter after DAG is the sum of the digits in the rest of the address, mod 9, as public_key_address writes it.
+        unsigned int sum = 0;
+        for (unsigned int id_ix = 4; id_ix < TOKEN_ID_LEN; id_ix++) {
+            assert_non_null(memchr(BASE58_ALPHABET, id[id_ix], sizeof(BASE58_ALPHABET) - 1));
+            if ((id[id_ix] >= '0') && (id[id_ix] <= '9')) {
+                sum += id[id_ix] - '0';
+            }
+        }
+        assert_int_equal(id[3], '0' + (sum % 9));
+
+        // the id is found by its own letters.
+        assert_true(token_find((const unsigned char *)id, TOKEN_ID_LEN) == token_at(ix));
+    }
+}
+
+static void registry_tickers_test(void **state) {
+    for (unsigned int ix = 0; ix < token_count(); ix++) {
+        const token_info_t *token = token_at(ix);
+        const char *end = memchr(token->ticker, '\0', sizeof(token->ticker));
+        assert_non_null(end);
+        assert_true(end > token->ticker);
+        for (const char *letter = token->ticker; letter < end; letter++) {
+            assert_true(((*letter >= 'A') && (*letter <= 'Z')) || ((*letter >= '0') && (*letter <= '9')));
+        }
+    }
+}
+
+static void registry_decimals_test(void **state) {
+    const unsigned char largest[8] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+    for (unsigned int ix = 0; ix < token_count(); ix++) {
+        const token_info_t *token = token_at(ix);
+        assert_true(token->decimals <= TOKEN_DECIMALS_MAX);
+
+        // the largest amount fits its screen.
+        format_display_value(0, largest, sizeof(largest), token->decimals);
+        assert_true(strlen(tx_desc[0][1]) > 0);
+    }
+}
+
+int main(void) {
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(registry_sorted_test),
+    cmocka_unit_test(registry_ids_test),
+    cmocka_unit_test(registry_tickers_test),
+    cmocka_unit_test(registry_decimals_test),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
@@ -0,0 +1,103 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "../../src/shared.h"
+#include "../../src/selector.h"
+#include "../../src/tokens.h"
+
+void test_throw(unsigned short error) {
+    fail_msg("unexpected throw 0x%04X", error);
+}
+
+unsigned int raw_tx_ix = 0;
+unsigned int raw_tx_len = 0;
+
+/** looks up a made up identifier of tokens_test.def by its first letters and repeated letter. */
+static const token_info_t * find(const char *start, char fill) {
+    unsigned char id[TOKEN_ID_LEN];
+    memset(id, fill, sizeof(id));
+    memmove(id, start, strlen(start));
+    return token_find(id, sizeof(id));
+}
+
+static void registry_sorted_test(void **state) {
+    assert_int_equal(token_count(), 3);
+    for (unsigned int ix = 1; ix < token_count(); ix++) {
+        assert_true(memcmp(token_at(ix - 1)->id, token_at(ix)->id, TOKEN_ID_LEN) < 0);
+    }
+    assert_null(token_at(token_count()));
+}
+
+static void token_find_test(void **state) {
+    // the first, middle and last entries, so the search reaches both ends.
+    assert_string_equal(find("DAG0", 'A')->ticker, "AAA");
+    assert_string_equal(find("DAG0", 'B')->ticker, "BBBBBBBB");
+    assert_string_equal(find("DAG5", 'Z')->ticker, "ZZZ");
+    assert_int_equal(find("DAG0", 'B')->decimals, 6);
+
+    // before, between and after the entries.
+    assert_null(find("DAG0", '0'));
+    assert_null(find("DAG0", 'C'));
+    assert_null(find("DAG9", 'Z'));
+
+    // a prefix of an identifier is not a match.
+    unsigned char id[TOKEN_ID_LEN];
+    memmove(id, token_at(0)->id, sizeof(id));
+    assert_null(token_find(id, sizeof(id) - 1));
+}
+
+static void select_token_amount_test(void **state) {
+    // 314000000, as in the functional test transaction.
+    const unsigned char tx[] = { 0x12, 0xb7, 0x42, 0x80 };
+    const tx_field_view_t view = { TX_FIELD_AMOUNT, KRYO_BASE16, sizeof(tx), 0 };
+
+    select_display_begin();
+    select_display_token(find("DAG0", 'B'));
+    select_display_field(tx, &view);
+    assert_string_equal(tx_desc[0][0], "$BBBBBBBB");
+    assert_string_equal(tx_desc[0][1], "314.000000");
+
+    // a new transaction is back to $DAG.
+    select_display_begin();
+    select_display_field(tx, &view);
+    assert_string_equal(tx_desc[0][0], "$DAG");
+    assert_string_equal(tx_desc[0][1], "3.14000000");
+}
+
+static void select_token_metagraph_test(void **state) {
+    const unsigned char tx[] = { 0x12, 0xb7, 0x42, 0x80 };
+    const tx_field_view_t view = { TX_FIELD_AMOUNT, KRYO_BASE16, sizeof(tx), 0 };
+
+    // the metagraph the ticker came from is the last screen.
+    select_display_begin();
+    select_display_token(find("DAG0", 'B'));
+    select_display_field(tx, &view);
+    select_display_end();
+    assert_int_equal(max_scr_ix, 2);
+    assert_string_equal(tx_desc[1][0], "Metagraph (host)");
+    assert_string_equal(tx_desc[1][1], "DAG0B...BBBBB");
+
+    // a $DAG transfer has no such screen.
+    select_display_begin();
+    select_display_field(tx, &view);
+    select_display_end();
+    assert_int_equal(max_scr_ix, 1);
+}
+
+int main(void) {
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(registry_sorted_test),
+    cmocka_unit_test(token_find_test),
+    cmocka_unit_test(select_token_amount_test),
+    cmocka_unit_test(select_token_metagraph_test),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+
+}